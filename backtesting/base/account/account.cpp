@@ -1,10 +1,10 @@
 #include "account.hpp"
 #include "common_interface/common.hpp"
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <limits>
-#include <variant>
 namespace back_trader {
 
 float Floor(float amount, float unit) { return unit > 0 ? unit * std::floor(amount / unit) : amount; }
@@ -14,11 +14,8 @@ float Round(float amount, float unit) { return unit > 0 ? unit * std::round(amou
 // Positive price is required for non-market orders.
 // Every order must specify a positive base amount or quote amount.
 bool is_valid_order(const Order &order) {
-    return (order.type == Order::Type::MARKET || order.price > 0) &&
-           ((std::holds_alternative<Order::BaseAmount>(order.amount) &&
-             std::get<Order::BaseAmount>(order.amount).base_amount > 0) ||
-            (std::holds_alternative<Order::QuoteAmount>(order.amount) &&
-             std::get<Order::QuoteAmount>(order.amount).quote_amount > 0));
+    return (order.type == Order::Type::MARKET || order.price > 0) && order.amount > 0 &&
+           order.kind() < Order::KindCount;
 }
 
 void Account::init_account(const AccountConfig &account_confg) {
@@ -75,7 +72,7 @@ float Account::get_stop_sell_price(const OhlcTick &ohlc_tick, float stop_price)
 
 bool Account::buy_base_currency(const FeeConfig &fee_config, float base_amount, float price) {
     assert(price > 0);
-    assert(base_amount > 0);
+    assert(base_amount >= 0);
     base_amount = Round(base_amount, base_unit);
 
     /*base unit is lowest denomination of base currency*/
@@ -303,75 +300,79 @@ bool Account::limit_sell_at_quote(const FeeConfig &fee_config, const OhlcTick &o
     return sell_at_quote(fee_config, quote_amount, limit_price, max_base_amount);
 }
 
+/*------------- Execute General Orders---------------------------*/
+
+/* Kernels of every (type, side, amount_kind) combination of order with the same signature (amount is base or quote
+ * amount according to the kind, price is not used by market orders).*/
+using OrderKernel = bool (*)(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick, float amount,
+                             float price);
+
+static bool market_buy_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick, float amount,
+                              float) {
+    return account.market_buy(fee_config, ohlc_tick, amount);
+}
+static bool market_buy_at_quote_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick,
+                                       float amount, float) {
+    return account.market_buy_at_quote(fee_config, ohlc_tick, amount);
+}
+static bool market_sell_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick, float amount,
+                               float) {
+    return account.market_sell(fee_config, ohlc_tick, amount);
+}
+static bool market_sell_at_quote_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick,
+                                        float amount, float) {
+    return account.market_sell_at_quote(fee_config, ohlc_tick, amount);
+}
+static bool stop_buy_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick, float amount,
+                            float price) {
+    return account.stop_buy(fee_config, ohlc_tick, amount, price);
+}
+static bool stop_buy_at_quote_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick,
+                                     float amount, float price) {
+    return account.stop_buy_at_quote(fee_config, ohlc_tick, amount, price);
+}
+static bool stop_sell_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick, float amount,
+                             float price) {
+    return account.stop_sell(fee_config, ohlc_tick, amount, price);
+}
+static bool stop_sell_at_quote_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick,
+                                      float amount, float price) {
+    return account.stop_sell_at_quote(fee_config, ohlc_tick, amount, price);
+}
+static bool limit_buy_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick, float amount,
+                             float price) {
+    return account.limit_buy(fee_config, ohlc_tick, amount, price);
+}
+static bool limit_buy_at_quote_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick,
+                                      float amount, float price) {
+    return account.limit_buy_at_quote(fee_config, ohlc_tick, amount, price);
+}
+static bool limit_sell_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick, float amount,
+                              float price) {
+    return account.limit_sell(fee_config, ohlc_tick, amount, price);
+}
+static bool limit_sell_at_quote_kernel(Account &account, const FeeConfig &fee_config, const OhlcTick &ohlc_tick,
+                                       float amount, float price) {
+    return account.limit_sell_at_quote(fee_config, ohlc_tick, amount, price);
+}
+
+// Indexed by Order::kind(), (type, side, amount_kind) in order of the enums.
+static constexpr std::array<OrderKernel, Order::KindCount> OrderKernels = {
+    market_buy_kernel, market_buy_at_quote_kernel, market_sell_kernel, market_sell_at_quote_kernel, // nowrap
+    stop_buy_kernel,   stop_buy_at_quote_kernel,   stop_sell_kernel,   stop_sell_at_quote_kernel,   // nowrap
+    limit_buy_kernel,  limit_buy_at_quote_kernel,  limit_sell_kernel,  limit_sell_at_quote_kernel,
+};
+
+// Fee config of the order type, indexed by Order::Type.
+static constexpr std::array<FeeConfig AccountConfig::*, static_cast<size_t>(Order::Type::Count)> OrderFeeConfigs = {
+    &AccountConfig::market_order_fee_config,
+    &AccountConfig::stop_order_fee_config,
+    &AccountConfig::limit_order_fee_config,
+};
+
 bool Account::execute_order(const AccountConfig &account_config, const Order &order, const OhlcTick &ohlc_tick) {
     assert(is_valid_order(order));
-    float possible_base_amount = std::holds_alternative<Order::BaseAmount>(order.amount)
-                                     ? std::get<Order::BaseAmount>(order.amount).base_amount
-                                     : 0.0;
-    float possible_quote_amount = std::holds_alternative<Order::QuoteAmount>(order.amount)
-                                      ? std::get<Order::QuoteAmount>(order.amount).quote_amount
-                                      : 0.0;
-    switch (order.type) {
-    case Order::Type::MARKET: {
-        if (order.side == Order::Side::BUY) {
-            if (std::holds_alternative<Order::BaseAmount>(order.amount)) {
-                return market_buy(account_config.market_order_fee_config, ohlc_tick, possible_base_amount);
-            } else {
-                return market_buy_at_quote(account_config.market_order_fee_config, ohlc_tick, possible_quote_amount);
-            }
-        } else {
-            assert(order.side == Order::Side::SELL);
-            if (std::holds_alternative<Order::BaseAmount>(order.amount)) {
-                return market_sell(account_config.market_order_fee_config, ohlc_tick, possible_base_amount);
-            } else {
-                assert(std::holds_alternative<Order::QuoteAmount>(order.amount));
-                return market_sell_at_quote(account_config.market_order_fee_config, ohlc_tick, possible_quote_amount);
-            }
-        }
-    } break;
-    case Order::Type::STOP: {
-        if (order.side == Order::Side::BUY) {
-            if (std::holds_alternative<Order::BaseAmount>(order.amount)) {
-                return stop_buy(account_config.stop_order_fee_config, ohlc_tick, possible_base_amount, order.price);
-            } else {
-                assert(std::holds_alternative<Order::QuoteAmount>(order.amount));
-                return stop_buy_at_quote(account_config.stop_order_fee_config, ohlc_tick, possible_quote_amount,
-                                         order.price);
-            }
-        } else {
-            assert(order.side == Order::Side::SELL);
-            if (std::holds_alternative<Order::BaseAmount>(order.amount)) {
-                return stop_sell(account_config.stop_order_fee_config, ohlc_tick, possible_base_amount, order.price);
-            } else {
-                assert(std::holds_alternative<Order::QuoteAmount>(order.amount));
-                return stop_sell_at_quote(account_config.stop_order_fee_config, ohlc_tick, possible_quote_amount,
-                                          order.price);
-            }
-        }
-    } break;
-    case Order::Type::LIMIT: {
-        if (order.side == Order::Side::BUY) {
-            if (std::holds_alternative<Order::BaseAmount>(order.amount)) {
-                return limit_buy(account_config.limit_order_fee_config, ohlc_tick, possible_base_amount, order.price);
-            } else {
-                assert(std::holds_alternative<Order::QuoteAmount>(order.amount));
-                return limit_buy_at_quote(account_config.limit_order_fee_config, ohlc_tick, possible_quote_amount,
-                                          order.price);
-            }
-        } else {
-            assert(order.side == Order::Side::SELL);
-            if (std::holds_alternative<Order::BaseAmount>(order.amount)) {
-                return limit_sell(account_config.limit_order_fee_config, ohlc_tick, possible_base_amount, order.price);
-            } else {
-                assert(std::holds_alternative<Order::QuoteAmount>(order.amount));
-                return limit_sell_at_quote(account_config.limit_order_fee_config, ohlc_tick, possible_quote_amount,
-                                           order.price);
-            }
-        }
-    } break;
-    default:
-        assert(false);
-    }
-    return true;
+    const FeeConfig &fee_config = account_config.*OrderFeeConfigs[static_cast<size_t>(order.type)];
+    return OrderKernels[order.kind()](*this, fee_config, ohlc_tick, order.amount, order.price);
 }
 } // namespace back_trader
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "fixed_point_account.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cstdlib>
+
+namespace back_trader {
+// 1.0 in Q32.
+static constexpr double OneQ32 = 4294967296.0;
+static constexpr int64_t FractionMaskQ32 = 0xFFFFFFFF;
+
+// value * q32 rounded down (Floor) and up (Ceil) to integer. Product is 128 bit, so it can't overflow.
+static int64_t multiply_q32_floor(int64_t value, int64_t q32) {
+    return static_cast<int64_t>((static_cast<__int128>(value) * q32) >> 32);
+}
+static int64_t multiply_q32_ceil(int64_t value, int64_t q32) {
+    return static_cast<int64_t>((static_cast<__int128>(value) * q32 + FractionMaskQ32) >> 32);
+}
+// value / q32 rounded down, value is not negative and q32 positive.
+static int64_t divide_q32_floor(int64_t value, int64_t q32) {
+    return static_cast<int64_t>((static_cast<__int128>(value) << 32) / q32);
+}
+// Not negative amount * units_per_amount rounded to the nearest unit (same as Round of Account).
+static int64_t to_units(float amount, double units_per_amount) {
+    return static_cast<int64_t>(amount * units_per_amount + 0.5);
+}
+
+void FixedPointAccount::init_account(const AccountConfig &account_config) {
+    assert(account_config.base_unit > 0 && account_config.quote_unit > 0);
+    base_unit = account_config.base_unit;
+    quote_unit = account_config.quote_unit;
+    market_liquidity = account_config.market_liquidity;
+    max_volume_ratio = account_config.max_volume_ratio;
+    base_units_per_amount = 1.0 / base_unit;
+    quote_units_per_amount = 1.0 / quote_unit;
+    price_scale_q32 = OneQ32 * base_unit * quote_units_per_amount;
+    base_balance_units = to_units(account_config.start_base_balance, base_units_per_amount);
+    quote_balance_units = to_units(account_config.start_quote_balance, quote_units_per_amount);
+    total_fee_units = 0;
+    market_order_fee = get_fixed_point_fee(account_config.market_order_fee_config, quote_units_per_amount);
+    stop_order_fee = get_fixed_point_fee(account_config.stop_order_fee_config, quote_units_per_amount);
+    limit_order_fee = get_fixed_point_fee(account_config.limit_order_fee_config, quote_units_per_amount);
+}
+
+FixedPointAccount::FixedPointFee FixedPointAccount::get_fixed_point_fee(const FeeConfig &fee_config,
+                                                                        double quote_units_per_amount) {
+    FixedPointFee fee;
+    fee.relative_fee_q32 = static_cast<int64_t>(fee_config.relative_fee * OneQ32 + 0.5);
+    fee.fixed_fee_q32 = static_cast<int64_t>(fee_config.fixed_fee * quote_units_per_amount * OneQ32 + 0.5);
+    fee.minimum_fee_q32 = static_cast<int64_t>(fee_config.minimum_fee * quote_units_per_amount * OneQ32 + 0.5);
+    return fee;
+}
+
+int64_t FixedPointAccount::get_price_q32(float price) const {
+    return static_cast<int64_t>(price * price_scale_q32 + 0.5);
+}
+
+/* Same as Account::get_fee, rounded up to quote unit.*/
+int64_t FixedPointAccount::get_fee_units(const FixedPointFee &fee, int64_t quote_units) const {
+    const __int128 fee_q32 = std::max<__int128>(
+        fee.minimum_fee_q32, fee.fixed_fee_q32 + static_cast<__int128>(quote_units) * fee.relative_fee_q32);
+    return static_cast<int64_t>((fee_q32 + FractionMaskQ32) >> 32);
+}
+
+/*
+ Base units of sell order amount. Amount taken from get_base_balance (int64 units -> float -> int64 units) is off by up
+ to the float rounding of the balance, such amount sells exactly the whole base balance instead of being rejected (or
+ leaving few units).
+*/
+int64_t FixedPointAccount::get_sell_base_units(float amount) const {
+    const int64_t base_units = to_units(amount, base_units_per_amount);
+    // 2 float roundings (units to float, multiply by base_unit), 0 (exact round trip) below 2^23 units
+    const int64_t rounding_units = static_cast<int64_t>(base_balance_units * (2 * FLT_EPSILON));
+    return std::abs(base_units - base_balance_units) <= rounding_units ? base_balance_units : base_units;
+}
+
+int64_t FixedPointAccount::get_max_base_units(const OhlcTick &ohlc_tick) const {
+    // cast truncates, which is floor of not negative volume
+    return max_volume_ratio > 0
+               ? static_cast<int64_t>(static_cast<double>(max_volume_ratio) * ohlc_tick.volume * base_units_per_amount)
+               : std::numeric_limits<int64_t>::max();
+}
+
+/*------------------------------------- Execute Order At Specific Price ---------------------------------------------*/
+
+bool FixedPointAccount::buy_base_currency(const FixedPointFee &fee, int64_t base_units, int64_t price_q32) {
+    /*base unit is lowest denomination of base currency*/
+    if (base_units < 1) {
+        return false;
+    }
+    const int64_t quote_units = multiply_q32_ceil(base_units, price_q32);
+    const int64_t fee_units = get_fee_units(fee, quote_units);
+    const int64_t total_quote_units = quote_units + fee_units;
+
+    /*Account is holding less balance than buy price*/
+    if (total_quote_units > quote_balance_units) {
+        return false;
+    }
+    base_balance_units += base_units;
+    quote_balance_units -= total_quote_units;
+    total_fee_units += fee_units;
+    return true;
+}
+
+/* Same as Account::buy_at_quote, which spends the whole quote balance (not the quote amount of the order).*/
+bool FixedPointAccount::buy_at_quote(const FixedPointFee &fee, int64_t price_q32, int64_t max_base_units) {
+    const int64_t quote_units = quote_balance_units;
+    if (quote_units < 1) {
+        return false;
+    }
+    const int64_t fee_units = get_fee_units(fee, quote_units);
+
+    /*all amount will get paid as fee*/
+    if (quote_units < fee_units) {
+        return false;
+    }
+    const int64_t base_units = std::min(divide_q32_floor(quote_units - fee_units, price_q32), max_base_units);
+    return buy_base_currency(fee, base_units, price_q32);
+}
+
+bool FixedPointAccount::sell_base_currency(const FixedPointFee &fee, int64_t base_units, int64_t price_q32) {
+    /* can't sell lower than lowest denomination for base currency, or more than which account have in base balance*/
+    if (base_units < 1 || base_units > base_balance_units) {
+        return false;
+    }
+    const int64_t quote_units = multiply_q32_floor(base_units, price_q32);
+    const int64_t fee_units = get_fee_units(fee, quote_units);
+    const int64_t total_quote_units = quote_units - fee_units;
+
+    /* After selling account is getting lower than lowest denomination.*/
+    if (total_quote_units < 1) {
+        return false;
+    }
+    base_balance_units -= base_units;
+    quote_balance_units += total_quote_units;
+    total_fee_units += fee_units;
+    return true;
+}
+
+bool FixedPointAccount::sell_at_quote(const FixedPointFee &fee, float quote_amount, int64_t price_q32,
+                                      int64_t max_base_units) {
+    const int64_t quote_units = to_units(quote_amount, quote_units_per_amount);
+    if (quote_units < 1) {
+        return false;
+    }
+    const int64_t fee_units = get_fee_units(fee, quote_units);
+    // Receiving at most quote_amount, see Account::sell_at_quote
+    const int64_t base_units = std::min(divide_q32_floor(quote_units + fee_units, price_q32), max_base_units);
+    return sell_base_currency(fee, base_units, price_q32);
+}
+
+/*------------- Execute General Orders---------------------------*/
+
+bool FixedPointAccount::execute_order(const AccountConfig &account_config, const Order &order,
+                                      const OhlcTick &ohlc_tick) {
+    const bool buy = order.side == Order::Side::BUY;
+    // Price (the same float expressions as Account) and fee of the order type, false when it's not triggered
+    const FixedPointFee *fee = nullptr;
+    float price = 0;
+    int64_t max_base_units = std::numeric_limits<int64_t>::max();
+    switch (order.type) {
+    case Order::Type::MARKET:
+        fee = &market_order_fee;
+        price = market_liquidity * ohlc_tick.open + (1.0f - market_liquidity) * (buy ? ohlc_tick.high : ohlc_tick.low);
+        break;
+    case Order::Type::STOP:
+        assert(order.price > 0);
+        /* Stop buy (sell) order only get executed when price RISE above (FALL below) the stop price*/
+        if (buy ? ohlc_tick.high < order.price : ohlc_tick.low > order.price)
+            return false;
+        fee = &stop_order_fee;
+        price = buy ? market_liquidity * std::max(order.price, ohlc_tick.open) +
+                          (1.0f - market_liquidity) * ohlc_tick.high
+                    : market_liquidity * std::min(order.price, ohlc_tick.open) +
+                          (1.0f - market_liquidity) * ohlc_tick.low;
+        break;
+    case Order::Type::LIMIT:
+        assert(order.price > 0);
+        /* Limit buy (sell) order only get executed when price FALL below (RISE above) the limit price*/
+        if (buy ? ohlc_tick.low > order.price : ohlc_tick.high < order.price)
+            return false;
+        fee = &limit_order_fee;
+        price = order.price;
+        max_base_units = get_max_base_units(ohlc_tick);
+        break;
+    default:
+        assert(false);
+        return false;
+    }
+    const int64_t price_q32 = get_price_q32(price);
+
+    if (order.amount_kind == Order::AmountKind::BASE) {
+        if (buy)
+            return buy_base_currency(*fee, std::min(to_units(order.amount, base_units_per_amount), max_base_units),
+                                     price_q32);
+        // Selling the whole balance (amount of get_base_balance) has to sell every unit
+        assert(get_sell_base_units(get_base_balance(*this)) == base_balance_units);
+        return sell_base_currency(*fee, std::min(get_sell_base_units(order.amount), max_base_units), price_q32);
+    }
+    assert(order.amount_kind == Order::AmountKind::QUOTE);
+    return buy ? buy_at_quote(*fee, price_q32, max_base_units)
+               : sell_at_quote(*fee, order.amount, price_q32, max_base_units);
+}
+} // namespace back_trader
@@ -0,0 +1,84 @@
+#pragma once
+#include "../common_interface/common.hpp"
+#include "account.hpp"
+#include <cstdint>
+#include <limits>
+
+namespace back_trader {
+/*
+ Account with the same execute_order contract as Account, but balances are exact integer counts of base_unit (ex:-
+ satoshi) and quote_unit (ex:- cent) instead of float amounts which are rounded to the units after every fill.
+ Prices and fees are fixed point numbers with 32 fractional bits (Q32) in quote units per base unit, so a fill is
+ integer multiply and shift (rounded down or up the same way Account rounds) instead of float division and
+ std::floor/std::round.
+ Balances are the same on every platform and thread count and don't drift however long the simulation runs.
+ Fee configs are taken from the AccountConfig of init_account.
+*/
+struct FixedPointAccount {
+    // balance in base_unit (Satoshi)
+    int64_t base_balance_units = 0;
+    // balance in quote_unit (cents)
+    int64_t quote_balance_units = 0;
+    // Total transaction fee over all executed order in quote_unit.
+    int64_t total_fee_units = 0;
+
+    float base_unit = 0;
+    float quote_unit = 0;
+    float market_liquidity = 1.0f;
+    float max_volume_ratio = 0.0f;
+
+    /* Initialize the account with config, base_unit and quote_unit has to be positive.*/
+    void init_account(const AccountConfig &account_config);
+
+    // Execute the order over the given ohlc_tick.
+    bool execute_order(const AccountConfig &account_config, const Order &order, const OhlcTick &ohlc_tick);
+
+  private:
+    // FeeConfig in Q32 quote units.
+    struct FixedPointFee {
+        int64_t relative_fee_q32;
+        int64_t fixed_fee_q32;
+        int64_t minimum_fee_q32;
+    };
+    FixedPointFee market_order_fee;
+    FixedPointFee stop_order_fee;
+    FixedPointFee limit_order_fee;
+    // 1 / base_unit and 1 / quote_unit, amounts are converted to units by multiplication.
+    double base_units_per_amount = 0;
+    double quote_units_per_amount = 0;
+    // Converts price (quote per 1 base) into Q32 quote units per 1 base unit.
+    double price_scale_q32 = 0;
+
+    static FixedPointFee get_fixed_point_fee(const FeeConfig &fee_config, double quote_units_per_amount);
+    int64_t get_price_q32(float price) const;
+    int64_t get_fee_units(const FixedPointFee &fee, int64_t quote_units) const;
+    int64_t get_sell_base_units(float amount) const;
+    int64_t get_max_base_units(const OhlcTick &ohlc_tick) const;
+
+    bool buy_base_currency(const FixedPointFee &fee, int64_t base_units, int64_t price_q32);
+    bool buy_at_quote(const FixedPointFee &fee, int64_t price_q32,
+                      int64_t max_base_units = std::numeric_limits<int64_t>::max());
+    bool sell_base_currency(const FixedPointFee &fee, int64_t base_units, int64_t price_q32);
+    bool sell_at_quote(const FixedPointFee &fee, float quote_amount, int64_t price_q32,
+                       int64_t max_base_units = std::numeric_limits<int64_t>::max());
+};
+
+// Balances (in base and quote currency) of either account.
+inline float get_base_balance(const Account &account) { return account.base_balance; }
+inline float get_quote_balance(const Account &account) { return account.quote_balance; }
+inline float get_total_fee(const Account &account) { return account.total_fee; }
+inline float get_base_balance(const FixedPointAccount &account) {
+    return account.base_balance_units * account.base_unit;
+}
+inline float get_quote_balance(const FixedPointAccount &account) {
+    return account.quote_balance_units * account.quote_unit;
+}
+inline float get_total_fee(const FixedPointAccount &account) { return account.total_fee_units * account.quote_unit; }
+
+// Account of the simulation loops, exact FixedPointAccount when built with FIXED_POINT_ACCOUNT.
+#ifdef FIXED_POINT_ACCOUNT
+using SimulationAccount = FixedPointAccount;
+#else
+using SimulationAccount = Account;
+#endif
+} // namespace back_trader
@@ -0,0 +1,163 @@
+#include "order_book.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace back_trader {
+static constexpr uint32_t SlotMask = 0xFFFFFFFF;
+
+static OrderId get_order_id(uint32_t slot, uint32_t generation) {
+    return (static_cast<OrderId>(generation) << 32) | slot;
+}
+
+// Limit buy and stop sell orders get triggered when price FALLS to them.
+static bool is_falling_trigger(const Order &order) {
+    return (order.type == Order::Type::LIMIT) == (order.side == Order::Side::BUY);
+}
+
+OrderBook::OrderBook(size_t capacity) : book_capacity(capacity) {
+    slots.reserve(capacity);
+    free_slots.reserve(capacity);
+    falling_triggers.reserve(capacity);
+    rising_triggers.reserve(capacity);
+    market_slots.reserve(capacity);
+    triggered_slots.reserve(capacity);
+}
+
+OrderId OrderBook::place(const Order &order) {
+    assert(order.amount > 0 && (order.type == Order::Type::MARKET || order.price > 0));
+    uint32_t slot;
+    if (free_slots.empty()) {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.push_back(OrderSlot{order, next_sequence++, 0, true});
+    } else {
+        slot = free_slots.back();
+        free_slots.pop_back();
+        OrderSlot &order_slot = slots[slot];
+        order_slot.order = order;
+        order_slot.sequence = next_sequence++;
+        order_slot.active = true;
+    }
+    add_to_index(slot);
+    ++order_count;
+    return get_order_id(slot, slots[slot].generation);
+}
+
+int64_t OrderBook::get_active_slot(OrderId order_id) const {
+    const uint32_t slot = static_cast<uint32_t>(order_id & SlotMask);
+    if (slot >= slots.size() || !slots[slot].active || slots[slot].generation != (order_id >> 32))
+        return -1;
+    return slot;
+}
+
+const Order *OrderBook::find(OrderId order_id) const {
+    const int64_t slot = get_active_slot(order_id);
+    return slot < 0 ? nullptr : &slots[slot].order;
+}
+
+bool OrderBook::modify(OrderId order_id, float amount, float price) {
+    const int64_t slot = get_active_slot(order_id);
+    if (slot < 0)
+        return false;
+    Order &order = slots[slot].order;
+    assert(amount > 0 && (order.type == Order::Type::MARKET || price > 0));
+    order.amount = amount;
+    if (order.price != price) {
+        remove_from_index(slot);
+        order.price = price;
+        add_to_index(slot);
+    }
+    return true;
+}
+
+bool OrderBook::cancel(OrderId order_id) {
+    const int64_t slot = get_active_slot(order_id);
+    if (slot < 0)
+        return false;
+    remove_order(slot);
+    return true;
+}
+
+void OrderBook::clear() {
+    for (uint32_t slot = 0; slot < slots.size(); ++slot) {
+        if (slots[slot].active)
+            remove_order(slot);
+    }
+}
+
+void OrderBook::add_to_index(uint32_t slot) {
+    const Order &order = slots[slot].order;
+    if (order.type == Order::Type::MARKET) {
+        market_slots.push_back(slot);
+        return;
+    }
+    std::vector<PriceEntry> &triggers = is_falling_trigger(order) ? falling_triggers : rising_triggers;
+    const PriceEntry entry{order.price, slot};
+    triggers.insert(std::upper_bound(triggers.begin(), triggers.end(), entry), entry);
+}
+
+void OrderBook::remove_from_index(uint32_t slot) {
+    const Order &order = slots[slot].order;
+    if (order.type == Order::Type::MARKET) {
+        market_slots.erase(std::find(market_slots.begin(), market_slots.end(), slot));
+        return;
+    }
+    std::vector<PriceEntry> &triggers = is_falling_trigger(order) ? falling_triggers : rising_triggers;
+    const auto entry_it = std::lower_bound(triggers.begin(), triggers.end(), PriceEntry{order.price, slot});
+    assert(entry_it != triggers.end() && entry_it->slot == slot);
+    triggers.erase(entry_it);
+}
+
+void OrderBook::remove_order(uint32_t slot) {
+    remove_from_index(slot);
+    OrderSlot &order_slot = slots[slot];
+    order_slot.active = false;
+    ++order_slot.generation;
+    free_slots.push_back(slot);
+    --order_count;
+}
+
+void OrderBook::collect_triggered_orders(const OhlcTick &ohlc_tick) {
+    triggered_slots.assign(market_slots.begin(), market_slots.end());
+    // Orders with price >= low (price FALLS to them) and price <= high (price RISE to them)
+    const auto falling_begin = std::lower_bound(
+        falling_triggers.begin(), falling_triggers.end(), ohlc_tick.low,
+        [](const PriceEntry &entry, float price) { return entry.price < price; });
+    for (auto entry_it = falling_begin; entry_it != falling_triggers.end(); ++entry_it)
+        triggered_slots.push_back(entry_it->slot);
+    const auto rising_end = std::upper_bound(rising_triggers.begin(), rising_triggers.end(), ohlc_tick.high,
+                                             [](float price, const PriceEntry &entry) { return price < entry.price; });
+    for (auto entry_it = rising_triggers.begin(); entry_it != rising_end; ++entry_it)
+        triggered_slots.push_back(entry_it->slot);
+    std::sort(triggered_slots.begin(), triggered_slots.end(),
+              [this](uint32_t a, uint32_t b) { return slots[a].sequence < slots[b].sequence; });
+}
+
+void OrderBook::settle_order(uint32_t slot, bool executed, float base_change, float quote_change,
+                             float max_base_amount, float base_unit, float quote_unit) {
+    Order &order = slots[slot].order;
+    if (order.type == Order::Type::LIMIT) {
+        // Limit order waits for the price until it's filled
+        if (!executed)
+            return;
+        const float filled_base_amount = std::abs(base_change);
+        if (order.amount_kind == Order::AmountKind::BASE) {
+            const float remaining_amount = order.amount - filled_base_amount;
+            if (remaining_amount > 0 && remaining_amount >= base_unit) {
+                order.amount = remaining_amount;
+                return;
+            }
+        } else if (filled_base_amount + base_unit > max_base_amount) {
+            /* Fill of quote amount misses few quote units of the amount (fee and unit rounding), such remainder would
+             never fill. Only a fill capped (to the floor of max base amount) by max_volume_ratio is partial.*/
+            const float filled_amount = order.side == Order::Side::BUY ? -quote_change : quote_change;
+            const float remaining_amount = order.amount - filled_amount;
+            if (remaining_amount > 0 && remaining_amount >= quote_unit) {
+                order.amount = remaining_amount;
+                return;
+            }
+        }
+    }
+    remove_order(slot);
+}
+} // namespace back_trader
@@ -0,0 +1,128 @@
+#pragma once
+#include "../common_interface/common.hpp"
+#include "fixed_point_account.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace back_trader {
+// Identifier of an order in OrderBook, slot of the order in lower 32 bits and generation of the slot in upper 32 bits
+// (so the id of a removed order never matches the order placed later into the same slot).
+using OrderId = uint64_t;
+
+/*
+ Good till cancelled orders of a simulator. Unlike the orders emitted by TradeSimulator::update (executed or cancelled
+ on the next OHLC tick), placed orders stay in the book over the OHLC ticks until they are filled or cancelled:
+ - Market and stop orders are removed once they are triggered (executed or not).
+ - Limit orders stay until they are completely filled, a limit order partially filled because of max_volume_ratio
+   keeps the remaining amount for the next OHLC ticks. Limit order of quote amount is filled unless max_volume_ratio
+   capped it (fee and unit rounding leave few quote units of it).
+ Limit buy and stop sell orders (triggered when the price FALLS to them) and stop buy and limit sell orders (triggered
+ when the price RISE to them) are kept sorted by price, so an OHLC tick finds the k triggered orders in O(log n + k)
+ instead of checking every order. Triggered orders are executed in the order they were placed.
+ Book doesn't allocate while it holds at most capacity orders.
+*/
+class OrderBook {
+  public:
+    explicit OrderBook(size_t capacity = 0);
+
+    size_t capacity() const { return book_capacity; }
+    size_t size() const { return order_count; }
+    bool empty() const { return order_count == 0; }
+
+    // Places the order (with positive amount, and positive price if it's not market order) into the book.
+    OrderId place(const Order &order);
+
+    // Active order of the id, nullptr if it was filled or cancelled.
+    const Order *find(OrderId order_id) const;
+
+    // Changes (remaining) amount and price of the active order, returns false if it was filled or cancelled.
+    bool modify(OrderId order_id, float amount, float price);
+
+    // Removes the active order, returns false if it was already filled or cancelled.
+    bool cancel(OrderId order_id);
+
+    // Cancels all the orders.
+    void clear();
+
+    /*
+     Executes the orders triggered by ohlc_tick on account, on_executed(order) is called after every executed order.
+     Returns the number of executed orders.
+    */
+    template <typename ExecutedCallback>
+    int execute(const AccountConfig &account_config, const OhlcTick &ohlc_tick, SimulationAccount &account,
+                ExecutedCallback &&on_executed) {
+        if (order_count == 0)
+            return 0;
+        collect_triggered_orders(ohlc_tick);
+        // Base amount limit orders are capped to on this tick (see Account::get_max_base_amount)
+        const float max_base_amount = account_config.max_volume_ratio > 0
+                                          ? account_config.max_volume_ratio * ohlc_tick.volume
+                                          : std::numeric_limits<float>::max();
+        int executed_count = 0;
+        for (const uint32_t slot : triggered_slots) {
+            const Order &order = slots[slot].order;
+            const float base_balance = get_base_balance(account);
+            const float quote_balance = get_quote_balance(account);
+            const bool executed = account.execute_order(account_config, order, ohlc_tick);
+            if (executed) {
+                ++executed_count;
+                on_executed(order);
+            }
+            settle_order(slot, executed, get_base_balance(account) - base_balance,
+                         get_quote_balance(account) - quote_balance, max_base_amount, account.base_unit,
+                         account.quote_unit);
+        }
+        return executed_count;
+    }
+
+  private:
+    struct OrderSlot {
+        Order order;
+        // Order of placement, triggered orders are executed in this order.
+        uint64_t sequence;
+        uint32_t generation;
+        bool active;
+    };
+
+    // Price index entry, sorted by price (and slot for equal prices).
+    struct PriceEntry {
+        float price;
+        uint32_t slot;
+
+        bool operator<(const PriceEntry &other) const {
+            return price < other.price || (price == other.price && slot < other.slot);
+        }
+    };
+
+    size_t book_capacity;
+    size_t order_count = 0;
+    uint64_t next_sequence = 0;
+    std::vector<OrderSlot> slots;
+    std::vector<uint32_t> free_slots;
+    // Limit buy and stop sell orders, triggered when OHLC low <= price.
+    std::vector<PriceEntry> falling_triggers;
+    // Stop buy and limit sell orders, triggered when OHLC high >= price.
+    std::vector<PriceEntry> rising_triggers;
+    // Market orders, triggered on the next OHLC tick.
+    std::vector<uint32_t> market_slots;
+    // Orders triggered by the OHLC tick being executed.
+    std::vector<uint32_t> triggered_slots;
+
+    // Slot of the active order of the id, -1 if there is none.
+    int64_t get_active_slot(OrderId order_id) const;
+    void add_to_index(uint32_t slot);
+    void remove_from_index(uint32_t slot);
+    void remove_order(uint32_t slot);
+    // Collects the orders triggered by ohlc_tick into triggered_slots in the order of placement.
+    void collect_triggered_orders(const OhlcTick &ohlc_tick);
+    /*
+     Removes the executed (triggered) order from the book, or keeps the remaining amount of partially filled limit
+     order. base_change and quote_change are the changes of account balances by the execution, max_base_amount is the
+     base amount limit orders were capped to.
+    */
+    void settle_order(uint32_t slot, bool executed, float base_change, float quote_change, float max_base_amount,
+                      float base_unit, float quote_unit);
+};
+} // namespace back_trader
@@ -1,11 +1,20 @@
 #pragma once
 #include "account/account.hpp"
+#include "account/fixed_point_account.hpp"
+#include "account/order_book.hpp"
 #include "common_interface/common.hpp"
 #include "price_history/fear_and_greed.hpp"
 #include "price_history/history_subset.hpp"
+#include "price_history/ohlc_columns.hpp"
+#include "price_history/ohlc_history_append.hpp"
+#include "price_history/ohlc_range_index.hpp"
 #include "price_history/price_history.hpp"
 #include "trade_simulator/trade_simulator.hpp"
+#include "util/aligned_allocator.hpp"
+#include "util/allocation_counter.hpp"
 #include "util/binary_io/binary_read_write.hpp"
 #include "util/cmd_line_args.hpp"
+#include "util/csv_io/csv_read.hpp"
 #include "util/maths_util.hpp"
-#include "util/quick_log.hpp"
\ No newline at end of file
+#include "util/quick_log.hpp"
+#include "util/thread_pool.hpp"
\ No newline at end of file
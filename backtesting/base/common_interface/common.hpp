@@ -2,8 +2,8 @@
 /*Common class, struct, data structure used across data_generator and backtesting trade*/
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
-#include <variant>
 namespace back_trader {
 
 /*
@@ -33,11 +33,21 @@ struct OhlcTick {
     float close;
     // Traded volume during the time interval
     float volume;
+    // Explicit (zero) padding, so the tick written to binary history file doesn't carry uninitialized bytes.
+    uint32_t padding = 0;
+};
+
+// Lowest low and highest high price over consecutive OHLC ticks.
+struct OhlcRange {
+    float low;
+    float high;
 };
 
 struct FearAndGreedRecord {
     int64_t timestamp_sec;
     float signal;
+    // Explicit (zero) padding, same as OhlcTick::padding.
+    uint32_t padding = 0;
 };
 
 struct FeeConfig {
@@ -77,8 +87,12 @@ struct AccountConfig {
     float max_volume_ratio;
 };
 
+/*
+ Flat (POD) order, amount is base or quote amount according to amount_kind. Every (type, side, amount_kind) combination
+ has its own index kind(), so executing the order is single lookup in a table of kernels instead of nested branches.
+*/
 struct Order {
-    enum class Type {
+    enum class Type : uint8_t {
 
         MARKET,
         STOP,
@@ -86,30 +100,40 @@ struct Order {
         Count,
     };
 
-    enum class Side {
+    enum class Side : uint8_t {
         BUY,
         SELL,
         Count,
     };
 
-    // The amount of base (crypto) currency to by buy / sell.
-    struct BaseAmount {
-        float base_amount;
-    };
-
-    /* The (maximum) amount of quote to be spent on buying (or to be received
-    when selling) the base (crypto) currency.
-    The actual traded amount might be smaller due to exchange fees. */
-    struct QuoteAmount {
-        float quote_amount;
+    enum class AmountKind : uint8_t {
+        // The amount of base (crypto) currency to by buy / sell.
+        BASE,
+        /* The (maximum) amount of quote to be spent on buying (or to be received
+        when selling) the base (crypto) currency.
+        The actual traded amount might be smaller due to exchange fees. */
+        QUOTE,
+        Count,
     };
 
-    using AmountType = std::variant<BaseAmount, QuoteAmount>;
+    // Number of (type, side, amount_kind) combinations.
+    static constexpr std::size_t KindCount = static_cast<std::size_t>(Type::Count) *
+                                             static_cast<std::size_t>(Side::Count) *
+                                             static_cast<std::size_t>(AmountKind::Count);
 
-    AmountType amount;
+    float amount;
+    float price;
     Type type;
     Side side;
-    float price;
+    AmountKind amount_kind;
+
+    // Index of (type, side, amount_kind) combination of the order from 0 to KindCount - 1.
+    constexpr std::size_t kind() const {
+        return (static_cast<std::size_t>(type) * static_cast<std::size_t>(Side::Count) +
+                static_cast<std::size_t>(side)) *
+                   static_cast<std::size_t>(AmountKind::Count) +
+               static_cast<std::size_t>(amount_kind);
+    }
 };
 
 constexpr std::array<const char *, static_cast<std::size_t>(Order::Side::Count)> get_side_strings() {
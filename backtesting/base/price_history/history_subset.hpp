@@ -1,5 +1,6 @@
 #pragma once
 #include "common_interface/common.hpp"
+#include "history_view.hpp"
 #include <algorithm>
 #include <cstdint>
 #include <utility>
@@ -19,12 +20,16 @@ using OhlcHistory = std::vector<OhlcTick>;
 // Historical FearAndGreeHistory inputs.
 using FearAndGreedHistory = std::vector<FearAndGreedRecord>;
 
+// Read only (zero copy) view of historical OHLC ticks, either over OhlcHistory or memory mapped history file.
+using OhlcHistoryView = HistoryView<OhlcTick>;
+
 /* Returns a std::pair of iterators covering the time interval [start, end) (not accidental pair don't include end) of
- * the given history, We can run these over all 3 types PriceRecord, OHLCTick and FearAndGreedRecord */
-template <typename T>
-std::pair<typename std::vector<T>::const_iterator, typename std::vector<T>::const_iterator>
-history_subset(const std::vector<T> &history, int64_t start_timestamp_sec, int64_t end_timestamp_sec) {
-    const auto record_compare = [](const T &record, int64_t timestamp_sec) {
+ * the given history, We can run these over all 3 types PriceRecord, OHLCTick and FearAndGreedRecord. History can be
+ * std::vector or HistoryView of them */
+template <typename H>
+std::pair<typename H::const_iterator, typename H::const_iterator>
+history_subset(const H &history, int64_t start_timestamp_sec, int64_t end_timestamp_sec) {
+    const auto record_compare = [](const typename H::value_type &record, int64_t timestamp_sec) {
         return record.timestamp_sec < timestamp_sec;
     };
     const auto record_begin =
@@ -0,0 +1,50 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace back_trader {
+/*
+ Read only view over contiguous history records. It's either a non owning view of std::vector (same history as before
+ just without copy) or a view over memory mapped binary history file which keeps the mapping alive through owner, so
+ records are never copied and only the pages which are actually read become resident.
+ Copies of the view (and subviews) share the same owner.
+*/
+template <typename T> class HistoryView {
+  public:
+    using value_type = T;
+    using const_iterator = const T *;
+    using iterator = const T *;
+
+    HistoryView() = default;
+    explicit HistoryView(const T *begin, const T *end, std::shared_ptr<const void> owner = nullptr)
+        : _begin(begin), _end(end), _owner(std::move(owner)) {
+        assert(_begin <= _end);
+    }
+    // Non owning view of history, history has to outlive the view (so not of a temporary).
+    explicit HistoryView(const std::vector<T> &history)
+        : _begin(history.data()), _end(history.data() + history.size()) {}
+    HistoryView(std::vector<T> &&) = delete;
+
+    const T *begin() const { return _begin; }
+    const T *end() const { return _end; }
+    const T *data() const { return _begin; }
+    size_t size() const { return static_cast<size_t>(_end - _begin); }
+    bool empty() const { return _begin == _end; }
+    const T &operator[](size_t i) const { return _begin[i]; }
+    const T &front() const { return *_begin; }
+    const T &back() const { return *(_end - 1); }
+
+    // View of [first, last) records of this view sharing the same owner.
+    HistoryView subview(const T *first, const T *last) const {
+        assert(_begin <= first && first <= last && last <= _end);
+        return HistoryView(first, last, _owner);
+    }
+
+  private:
+    const T *_begin = nullptr;
+    const T *_end = nullptr;
+    std::shared_ptr<const void> _owner;
+};
+} // namespace back_trader
@@ -0,0 +1,67 @@
+#include "ohlc_columns.hpp"
+#include <algorithm>
+
+namespace back_trader {
+OhlcColumns::OhlcColumns(const OhlcHistoryView &ohlc_history) {
+    reserve(ohlc_history.size());
+    for (const OhlcTick &ohlc_tick : ohlc_history)
+        push_back(ohlc_tick);
+}
+
+OhlcHistory OhlcColumns::to_ohlc_history() const {
+    OhlcHistory ohlc_history;
+    ohlc_history.reserve(size());
+    for (size_t i = 0; i < size(); ++i)
+        ohlc_history.push_back((*this)[i]);
+    return ohlc_history;
+}
+
+void OhlcColumns::reserve(size_t size) {
+    _timestamp_sec.reserve(size);
+    _open.reserve(size);
+    _high.reserve(size);
+    _low.reserve(size);
+    _close.reserve(size);
+    _volume.reserve(size);
+}
+
+void OhlcColumns::push_back(const OhlcTick &ohlc_tick) {
+    _timestamp_sec.push_back(ohlc_tick.timestamp_sec);
+    _open.push_back(ohlc_tick.open);
+    _high.push_back(ohlc_tick.high);
+    _low.push_back(ohlc_tick.low);
+    _close.push_back(ohlc_tick.close);
+    _volume.push_back(ohlc_tick.volume);
+}
+
+void OhlcColumns::clear() {
+    _timestamp_sec.clear();
+    _open.clear();
+    _high.clear();
+    _low.clear();
+    _close.clear();
+    _volume.clear();
+}
+
+std::pair<size_t, size_t> history_subset(const OhlcColumns &ohlc_columns, int64_t start_timestamp_sec,
+                                         int64_t end_timestamp_sec) {
+    const int64_t *timestamp_begin = ohlc_columns.timestamp_sec();
+    const int64_t *timestamp_end = timestamp_begin + ohlc_columns.size();
+    const int64_t *record_begin =
+        start_timestamp_sec > 0 ? std::lower_bound(timestamp_begin, timestamp_end, start_timestamp_sec)
+                                : timestamp_begin;
+    const int64_t *record_end =
+        end_timestamp_sec > 0 ? std::lower_bound(timestamp_begin, timestamp_end, end_timestamp_sec) : timestamp_end;
+    return std::make_pair(record_begin - timestamp_begin, std::max(record_begin, record_end) - timestamp_begin);
+}
+
+OhlcColumns history_subset_copy(const OhlcColumns &ohlc_columns, int64_t start_timestamp_sec,
+                                int64_t end_timestamp_sec) {
+    const std::pair<size_t, size_t> subset = history_subset(ohlc_columns, start_timestamp_sec, end_timestamp_sec);
+    OhlcColumns ohlc_columns_subset;
+    ohlc_columns_subset.reserve(subset.second - subset.first);
+    for (size_t i = subset.first; i < subset.second; ++i)
+        ohlc_columns_subset.push_back(ohlc_columns[i]);
+    return ohlc_columns_subset;
+}
+} // namespace back_trader
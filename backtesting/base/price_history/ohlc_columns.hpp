@@ -0,0 +1,57 @@
+#pragma once
+#include "history_subset.hpp"
+#include "util/aligned_allocator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace back_trader {
+/*
+ Columnar (structure of arrays) OHLC history. Every field is its own SimdAlignment aligned array, so a pass which
+ needs only some fields (ex:- close for returns, high/low for stop triggers) streams just those columns instead of
+ every 32 byte OhlcTick, and loops over a column can be vectorized.
+ i-th element of every column is the i-th OHLC tick.
+*/
+class OhlcColumns {
+  public:
+    OhlcColumns() = default;
+    explicit OhlcColumns(const OhlcHistoryView &ohlc_history);
+    explicit OhlcColumns(const OhlcHistory &ohlc_history) : OhlcColumns(OhlcHistoryView(ohlc_history)) {}
+
+    OhlcHistory to_ohlc_history() const;
+
+    void reserve(size_t size);
+    void push_back(const OhlcTick &ohlc_tick);
+    void clear();
+
+    size_t size() const { return _timestamp_sec.size(); }
+    bool empty() const { return _timestamp_sec.empty(); }
+    OhlcTick operator[](size_t i) const {
+        return {_timestamp_sec[i], _open[i], _high[i], _low[i], _close[i], _volume[i]};
+    }
+
+    const int64_t *timestamp_sec() const { return _timestamp_sec.data(); }
+    const float *open() const { return _open.data(); }
+    const float *high() const { return _high.data(); }
+    const float *low() const { return _low.data(); }
+    const float *close() const { return _close.data(); }
+    const float *volume() const { return _volume.data(); }
+
+  private:
+    AlignedVector<int64_t> _timestamp_sec;
+    AlignedVector<float> _open;
+    AlignedVector<float> _high;
+    AlignedVector<float> _low;
+    AlignedVector<float> _close;
+    AlignedVector<float> _volume;
+};
+
+/* Returns pair of indexes covering the time interval [start, end) of ohlc_columns, same as history_subset of
+ OhlcHistory. Only timestamp column is searched. */
+std::pair<size_t, size_t> history_subset(const OhlcColumns &ohlc_columns, int64_t start_timestamp_sec,
+                                         int64_t end_timestamp_sec);
+
+// Returns copy of ohlc_columns covering the time interval [start_timestamp_sec, end_timestamp_sec).
+OhlcColumns history_subset_copy(const OhlcColumns &ohlc_columns, int64_t start_timestamp_sec,
+                                int64_t end_timestamp_sec);
+} // namespace back_trader
@@ -0,0 +1,92 @@
+#include "ohlc_history_append.hpp"
+#include "price_history.hpp"
+#include "util/binary_io/binary_read_write.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+
+namespace back_trader {
+bool append_price_history_to_ohlc_history_files(const PriceHistory &price_history,
+                                                float max_price_deviation_per_min,
+                                                const std::vector<int> &interval_rates_sec,
+                                                const std::vector<std::string> &ohlc_history_binary_files) {
+    std::vector<OhlcHistory> ohlc_histories(interval_rates_sec.size());
+    std::vector<size_t> record_counts(interval_rates_sec.size());
+    std::vector<size_t> first_record_indexes(interval_rates_sec.size());
+    const int max_interval_rate_sec = *std::max_element(interval_rates_sec.begin(), interval_rates_sec.end());
+    int64_t last_source_timestamp_sec = 0;
+    int64_t known_last_source_timestamp_sec = 0;
+    for (size_t i = 0; i < ohlc_history_binary_files.size(); ++i) {
+        if (!std::ifstream(ohlc_history_binary_files[i]).good()) {
+            logError(string_format("Cannot append to ", ohlc_history_binary_files[i], ", generate it first"));
+            return false;
+        }
+        const OhlcHistoryView ohlc_history =
+            read_history_view_from_binary_file<OhlcTick>(ohlc_history_binary_files[i], 0, 0);
+        record_counts[i] = ohlc_history.size();
+        if (ohlc_history.empty())
+            continue;
+        // Ticks within the last tick of the coarsest interval and the one before them, see OhlcHistoriesBuilder::resume
+        const int64_t last_timestamp_sec = ohlc_history.back().timestamp_sec;
+        const OhlcTick *first_tick = std::upper_bound(ohlc_history.begin(), ohlc_history.end(),
+                                                      last_timestamp_sec - max_interval_rate_sec,
+                                                      [](int64_t timestamp_sec, const OhlcTick &ohlc_tick) {
+                                                          return timestamp_sec < ohlc_tick.timestamp_sec;
+                                                      });
+        if (first_tick != ohlc_history.begin())
+            --first_tick;
+        first_record_indexes[i] = static_cast<size_t>(first_tick - ohlc_history.begin());
+        ohlc_histories[i].assign(first_tick, ohlc_history.end());
+        // Last tick in the file might be updated already by an interrupted append, header has it as it was
+        OhlcTick last_ohlc_tick;
+        if (read_last_record_from_binary_file(ohlc_history_binary_files[i], last_ohlc_tick)) {
+            if (last_ohlc_tick.timestamp_sec != last_timestamp_sec) {
+                logError(string_format(ohlc_history_binary_files[i], " header doesn't match its last OHLC tick"));
+                return false;
+            }
+            ohlc_histories[i].back() = last_ohlc_tick;
+        }
+
+        int64_t file_last_source_timestamp_sec =
+            read_last_source_timestamp_from_binary_file(ohlc_history_binary_files[i]);
+        if (file_last_source_timestamp_sec == 0) {
+            // Last price record was somewhere within the last tick, records from there on might be already in it
+            file_last_source_timestamp_sec = last_timestamp_sec + interval_rates_sec[i] - 1;
+            if (price_history.front().timestamp_sec <= file_last_source_timestamp_sec) {
+                logError(string_format(ohlc_history_binary_files[i], " doesn't know its last price record, ",
+                                       "price history has to start after ", file_last_source_timestamp_sec,
+                                       " (or regenerate the file)"));
+                return false;
+            }
+        } else if (known_last_source_timestamp_sec != 0 &&
+                   known_last_source_timestamp_sec != file_last_source_timestamp_sec) {
+            logError(string_format("OHLC history files were built from different price records (last at ",
+                                   known_last_source_timestamp_sec, " and ", file_last_source_timestamp_sec, ")"));
+            return false;
+        } else {
+            known_last_source_timestamp_sec = file_last_source_timestamp_sec;
+        }
+        last_source_timestamp_sec = std::max(last_source_timestamp_sec, file_last_source_timestamp_sec);
+    }
+
+    std::vector<size_t> outlier_indexes;
+    const size_t skipped_records = append_clean_outliers_and_update_data_frequency(
+        price_history.begin(), price_history.end(), last_source_timestamp_sec, max_price_deviation_per_min,
+        interval_rates_sec, ohlc_histories, &outlier_indexes);
+    last_source_timestamp_sec = std::max(last_source_timestamp_sec, price_history.back().timestamp_sec);
+    logInfo(string_format("Skipped ", skipped_records, " records already in OHLC history, removed ",
+                          outlier_indexes.size(), " outliers"));
+
+    for (size_t i = 0; i < ohlc_histories.size(); ++i) {
+        // OHLC ticks from the first one read from the file on, the last one read is updated
+        const size_t read_record_count = record_counts[i] - first_record_indexes[i];
+        logInfo(string_format("Appending ", ohlc_histories[i].size() - read_record_count, " OHLC ticks (",
+                              interval_rates_sec[i], " sec)"));
+        if (!update_history_tail_in_binary_file(ohlc_histories[i], first_record_indexes[i],
+                                                ohlc_history_binary_files[i], last_source_timestamp_sec))
+            return false;
+    }
+    return true;
+}
+} // namespace back_trader
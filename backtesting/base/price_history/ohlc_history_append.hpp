@@ -0,0 +1,19 @@
+#pragma once
+#include "history_subset.hpp"
+#include <string>
+#include <vector>
+
+namespace back_trader {
+/* Append OHLC ticks of new price history to existing OHLC history files (one for every interval rate, same as they were
+ generated). Only the last ticks of every file are read, the last (open) OHLC tick is updated and new ticks are appended
+ in place, so the files are the same as generated from the whole price history at once. Price records up to the last
+ one the files were built from are skipped. Files which don't know it (written by older version or built from OHLC
+ history) can only take price history starting after their last OHLC tick.
+ Every file is continued from the copy of its last tick in the header (see update_history_tail_in_binary_file), so the
+ append interrupted before a file header was written can be repeated. Files are updated one by one, so when some of
+ them were updated already the append stops as they were built from different price records. */
+bool append_price_history_to_ohlc_history_files(const PriceHistory &price_history,                    // nowrap
+                                                float max_price_deviation_per_min,                    // nowrap
+                                                const std::vector<int> &interval_rates_sec,           // nowrap
+                                                const std::vector<std::string> &ohlc_history_binary_files);
+} // namespace back_trader
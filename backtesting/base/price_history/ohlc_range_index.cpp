@@ -0,0 +1,202 @@
+#include "ohlc_range_index.hpp"
+#include "util/binary_io/binary_read_write.hpp"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+namespace back_trader {
+// "BTRANGES" followed by the header, low and high columns and prefix, suffix and block table ranges.
+static constexpr char RangeIndexFileMagic[8] = {'B', 'T', 'R', 'A', 'N', 'G', 'E', 'S'};
+// Bump when layout of the file changes.
+static constexpr uint32_t RangeIndexFileVersion = 3;
+
+// Size is multiple of 8 bytes, so the columns and ranges after it are aligned in the memory mapped file.
+struct RangeIndexFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t block_size;
+    // History file the index was built from, all of its ticks are indexed.
+    RangeIndexSource source;
+};
+
+// Built prefix, suffix and block table ranges.
+struct RangeIndexTables {
+    std::vector<OhlcRange> prefix_ranges;
+    std::vector<OhlcRange> suffix_ranges;
+    std::vector<OhlcRange> block_table;
+};
+
+static OhlcRange combine_ranges(const OhlcRange &a, const OhlcRange &b) {
+    return {std::min(a.low, b.low), std::max(a.high, b.high)};
+}
+
+// floor(log2(value)) of positive value.
+static size_t floor_log2(size_t value) {
+    size_t log = 0;
+    while (value >>= 1)
+        ++log;
+    return log;
+}
+
+static size_t get_block_count(size_t tick_count) {
+    return (tick_count + OhlcRangeIndex::BlockSize - 1) / OhlcRangeIndex::BlockSize;
+}
+
+// Number of entries of the sparse table over block_count (not 0) blocks.
+static size_t get_block_table_size(size_t block_count) { return (floor_log2(block_count) + 1) * block_count; }
+
+static RangeIndexFileHeader get_range_index_file_header(const RangeIndexSource &source) {
+    RangeIndexFileHeader header{};
+    std::memcpy(header.magic, RangeIndexFileMagic, sizeof(header.magic));
+    header.version = RangeIndexFileVersion;
+    header.block_size = OhlcRangeIndex::BlockSize;
+    header.source = source;
+    return header;
+}
+
+// Size of index file of tick_count (not 0) ticks.
+static size_t get_range_index_file_size(size_t tick_count) {
+    return sizeof(RangeIndexFileHeader) + 2 * tick_count * sizeof(float) +
+           (2 * tick_count + get_block_table_size(get_block_count(tick_count))) * sizeof(OhlcRange);
+}
+
+bool get_range_index_source(const std::string &history_file_name, RangeIndexSource &source) {
+    HistoryFileHeader history_header;
+    if (!read_history_file_header(history_file_name, history_header))
+        return false;
+    std::error_code error;
+    const std::filesystem::file_time_type modified_time = std::filesystem::last_write_time(history_file_name, error);
+    if (error)
+        return false;
+    source = RangeIndexSource{};
+    source.record_count = history_header.record_count;
+    source.first_timestamp_sec = history_header.first_timestamp_sec;
+    source.last_timestamp_sec = history_header.last_timestamp_sec;
+    source.last_source_timestamp_sec = get_last_source_timestamp_sec(history_header);
+    source.modified_time_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(modified_time.time_since_epoch()).count();
+    return true;
+}
+
+OhlcRangeIndex::OhlcRangeIndex(const OhlcHistoryView &ohlc_history, const OhlcColumns &ohlc_columns)
+    : _ohlc_history(ohlc_history.data()), _tick_count(ohlc_history.size()),
+      _block_count(get_block_count(ohlc_history.size())), _low(ohlc_columns.low()), _high(ohlc_columns.high()) {
+    assert(ohlc_columns.size() == ohlc_history.size());
+    if (_block_count == 0)
+        return;
+    auto tables = std::make_shared<RangeIndexTables>();
+    std::vector<OhlcRange> &prefix_ranges = tables->prefix_ranges;
+    std::vector<OhlcRange> &suffix_ranges = tables->suffix_ranges;
+    std::vector<OhlcRange> &block_table = tables->block_table;
+    prefix_ranges.resize(_tick_count);
+    suffix_ranges.resize(_tick_count);
+    for (size_t block = 0; block < _block_count; ++block) {
+        const size_t block_begin = block * BlockSize;
+        const size_t block_end = std::min(block_begin + BlockSize, _tick_count);
+        OhlcRange range{_low[block_begin], _high[block_begin]};
+        for (size_t i = block_begin; i < block_end; ++i) {
+            range = combine_ranges(range, {_low[i], _high[i]});
+            prefix_ranges[i] = range;
+        }
+        range = {_low[block_end - 1], _high[block_end - 1]};
+        for (size_t i = block_end; i-- > block_begin;) {
+            range = combine_ranges(range, {_low[i], _high[i]});
+            suffix_ranges[i] = range;
+        }
+    }
+
+    // Level 0 is range of every block (its prefix up to the last tick), level k combines two entries of level k - 1
+    const size_t level_count = floor_log2(_block_count) + 1;
+    block_table.resize(get_block_table_size(_block_count));
+    for (size_t block = 0; block < _block_count; ++block)
+        block_table[block] = prefix_ranges[std::min((block + 1) * BlockSize, _tick_count) - 1];
+    for (size_t level = 1; level < level_count; ++level) {
+        const OhlcRange *previous_level = &block_table[(level - 1) * _block_count];
+        OhlcRange *current_level = &block_table[level * _block_count];
+        const size_t half_span = size_t(1) << (level - 1);
+        for (size_t block = 0; block + 2 * half_span <= _block_count; ++block)
+            current_level[block] = combine_ranges(previous_level[block], previous_level[block + half_span]);
+    }
+    _prefix_ranges = prefix_ranges.data();
+    _suffix_ranges = suffix_ranges.data();
+    _block_table = block_table.data();
+    _storage = std::move(tables);
+}
+
+OhlcRange OhlcRangeIndex::get_block_range(size_t begin_block, size_t end_block) const {
+    assert(begin_block < end_block && end_block <= _block_count);
+    const size_t level = floor_log2(end_block - begin_block);
+    const OhlcRange *table_level = &_block_table[level * _block_count];
+    return combine_ranges(table_level[begin_block], table_level[end_block - (size_t(1) << level)]);
+}
+
+OhlcRange OhlcRangeIndex::get_range(size_t begin, size_t end) const {
+    assert(begin < end && end <= _tick_count);
+    const size_t last = end - 1;
+    const size_t begin_block = begin / BlockSize;
+    const size_t last_block = last / BlockSize;
+    if (begin_block == last_block)
+        return scan_range(begin, end);
+    const OhlcRange range = combine_ranges(_suffix_ranges[begin], _prefix_ranges[last]);
+    return last_block - begin_block > 1 ? combine_ranges(range, get_block_range(begin_block + 1, last_block)) : range;
+}
+
+OhlcRange OhlcRangeIndex::scan_range(size_t begin, size_t end) const {
+    // Separate min and max passes over contiguous columns are vectorized
+    return {*std::min_element(_low + begin, _low + end), *std::max_element(_high + begin, _high + end)};
+}
+
+bool OhlcRangeIndex::write_to_file(const std::string &file_name, const RangeIndexSource &source) const {
+    assert(source.record_count == _tick_count);
+    if (_tick_count == 0)
+        return false;
+    std::ofstream index_stream(file_name, std::ios::binary);
+    if (!index_stream)
+        return false;
+    const RangeIndexFileHeader header = get_range_index_file_header(source);
+    index_stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    index_stream.write(reinterpret_cast<const char *>(_low), _tick_count * sizeof(float));
+    index_stream.write(reinterpret_cast<const char *>(_high), _tick_count * sizeof(float));
+    index_stream.write(reinterpret_cast<const char *>(_prefix_ranges), _tick_count * sizeof(OhlcRange));
+    index_stream.write(reinterpret_cast<const char *>(_suffix_ranges), _tick_count * sizeof(OhlcRange));
+    index_stream.write(reinterpret_cast<const char *>(_block_table),
+                       get_block_table_size(_block_count) * sizeof(OhlcRange));
+    return static_cast<bool>(index_stream);
+}
+
+bool OhlcRangeIndex::read_from_file(const std::string &file_name, const RangeIndexSource &source,
+                                    const OhlcHistoryView &ohlc_history) {
+    // Index is of the whole history file
+    if (ohlc_history.empty() || ohlc_history.size() != source.record_count ||
+        ohlc_history.front().timestamp_sec != source.first_timestamp_sec ||
+        ohlc_history.back().timestamp_sec != source.last_timestamp_sec)
+        return false;
+    // Missing or truncated file is never mapped
+    std::error_code error;
+    const size_t tick_count = ohlc_history.size();
+    if (std::filesystem::file_size(file_name, error) != get_range_index_file_size(tick_count) || error)
+        return false;
+    auto index_file = std::make_shared<const common_util::RMemoryMapped<char>>(file_name);
+    const RangeIndexFileHeader expected_header = get_range_index_file_header(source);
+    if (std::memcmp(index_file->begin(), &expected_header, sizeof(expected_header)) != 0)
+        return false;
+    const char *columns = index_file->begin() + sizeof(RangeIndexFileHeader);
+    const OhlcRange *ranges = reinterpret_cast<const OhlcRange *>(columns + 2 * tick_count * sizeof(float));
+    _ohlc_history = ohlc_history.data();
+    _tick_count = tick_count;
+    _block_count = get_block_count(tick_count);
+    _low = reinterpret_cast<const float *>(columns);
+    _high = _low + tick_count;
+    _prefix_ranges = ranges;
+    _suffix_ranges = ranges + tick_count;
+    _block_table = ranges + 2 * tick_count;
+    _storage = std::move(index_file);
+    return true;
+}
+} // namespace back_trader
@@ -0,0 +1,98 @@
+#pragma once
+#include "history_subset.hpp"
+#include "ohlc_columns.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace back_trader {
+/*
+ Identifies the content of binary history file (.mov) without reading its ticks, so a persisted index is checked in
+ O(1). Header fields change whenever ticks are appended or the last one is updated, modification time when the file is
+ regenerated over the same time range (ex:- with other outlier filter settings).
+*/
+struct RangeIndexSource {
+    uint64_t record_count;
+    int64_t first_timestamp_sec;
+    int64_t last_timestamp_sec;
+    int64_t last_source_timestamp_sec;
+    int64_t modified_time_ns;
+};
+
+/* Reads RangeIndexSource of history file, returns false if it can't be read or doesn't have (uncompressed) history
+ header, then its index can't be persisted. */
+bool get_range_index_source(const std::string &history_file_name, RangeIndexSource &source);
+
+/*
+ Lowest low and highest high (OhlcRange) of any OHLC ticks [begin, end) of history in O(1), built once per history and
+ shared (read only) by executors, analytics and strategies instead of scanning the ticks.
+ History is split into blocks of BlockSize ticks. Every tick keeps the range from the start of its block (prefix) and to
+ the end of its block (suffix), and a sparse table keeps the ranges of 2^k consecutive blocks. Query is suffix of the
+ first block + two (overlapping) sparse table entries of the blocks between + prefix of the last block, only ranges
+ within single block are scanned (at most BlockSize ticks).
+ Index is built from and scans only the low and high columns of OhlcColumns of the history, 8 contiguous bytes per tick
+ instead of every 32 byte OhlcTick.
+ Takes 16 bytes per tick plus the sparse table over blocks, instead of n log n ranges of sparse table over ticks.
+ Indexed history and its columns have to outlive the index, copies of the index share its tables.
+*/
+class OhlcRangeIndex {
+  public:
+    static constexpr size_t BlockSize = 32;
+
+    OhlcRangeIndex() = default;
+    // Index of ohlc_history, ohlc_columns are the columns of the same ticks.
+    OhlcRangeIndex(const OhlcHistoryView &ohlc_history, const OhlcColumns &ohlc_columns);
+
+    // Number of indexed OHLC ticks.
+    size_t size() const { return _tick_count; }
+
+    // True if ticks of ohlc_history (ex:- time range of the indexed history) are indexed.
+    bool covers(const OhlcHistoryView &ohlc_history) const {
+        return ohlc_history.empty() ||
+               (_ohlc_history <= ohlc_history.begin() && ohlc_history.end() <= _ohlc_history + _tick_count);
+    }
+
+    // Range of OHLC ticks [begin, end) (not empty) of the indexed history.
+    OhlcRange get_range(size_t begin, size_t end) const;
+    // Range of OHLC ticks [ohlc_begin, ohlc_end) (not empty) of any view within the indexed history.
+    OhlcRange get_range(OhlcHistoryView::const_iterator ohlc_begin, OhlcHistoryView::const_iterator ohlc_end) const {
+        return get_range(ohlc_begin - _ohlc_history, ohlc_end - _ohlc_history);
+    }
+
+    /*
+     Writes the index of whole history file (ex:- next to it) identified by source, with the low and high columns, so
+     it can be read without the columns. Returns false if it can't be written.
+    */
+    bool write_to_file(const std::string &file_name, const RangeIndexSource &source) const;
+
+    /*
+     Memory maps index written by write_to_file for ohlc_history, which has to be the whole history file identified by
+     source. Returns false if file can't be read or is index of another version of the history file (source differ),
+     the index has to be built then. Nothing is read or checked per tick.
+    */
+    bool read_from_file(const std::string &file_name, const RangeIndexSource &source,
+                        const OhlcHistoryView &ohlc_history);
+
+  private:
+    // First indexed tick, ticks are addressed by their offset from it.
+    const OhlcTick *_ohlc_history = nullptr;
+    size_t _tick_count = 0;
+    size_t _block_count = 0;
+    // Low and high columns of the indexed ticks.
+    const float *_low = nullptr;
+    const float *_high = nullptr;
+    // Range from the start of the block to the tick (prefix) and from the tick to the end of the block (suffix).
+    const OhlcRange *_prefix_ranges = nullptr;
+    const OhlcRange *_suffix_ranges = nullptr;
+    // Level k (_block_count entries from k * _block_count) is range of 2^k blocks from the block.
+    const OhlcRange *_block_table = nullptr;
+    // Owner of the ranges (built tables or memory mapped index file).
+    std::shared_ptr<const void> _storage;
+
+    // Range of blocks [begin_block, end_block) (not empty).
+    OhlcRange get_block_range(size_t begin_block, size_t end_block) const;
+    // Range of ticks [begin, end) (not empty) scanned from the columns.
+    OhlcRange scan_range(size_t begin, size_t end) const;
+};
+} // namespace back_trader
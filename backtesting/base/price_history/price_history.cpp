@@ -16,6 +16,47 @@ bool check_price_history_timestamps(const PriceHistory &price_history) {
     return true;
 }
 
+/* Records are checked in blocks, is_invalid is evaluated for the whole block without any branch (so compiler can
+ vectorize it) and the block is only walked record by record again when it has an invalid record, which is rare. */
+template <typename T, typename IsInvalid>
+std::vector<size_t> find_invalid_records(const T *begin, const T *end, IsInvalid is_invalid) {
+    constexpr size_t BlockSize = 256;
+    std::vector<size_t> invalid_indexes;
+    const size_t record_count = static_cast<size_t>(end - begin);
+    uint8_t invalid[BlockSize];
+    for (size_t block_begin = 0; block_begin < record_count; block_begin += BlockSize) {
+        const T *block = begin + block_begin;
+        const size_t block_size = std::min(BlockSize, record_count - block_begin);
+        uint8_t any_invalid = 0;
+        for (size_t i = 0; i < block_size; ++i) {
+            invalid[i] = is_invalid(block[i]);
+            any_invalid |= invalid[i];
+        }
+        if (!any_invalid)
+            continue;
+        for (size_t i = 0; i < block_size; ++i) {
+            if (invalid[i])
+                invalid_indexes.push_back(block_begin + i);
+        }
+    }
+    return invalid_indexes;
+}
+
+// Conditions are combined with | (not ||) to keep them branchless, negated comparisons also catch NaN.
+std::vector<size_t> find_invalid_price_records(const PriceRecord *begin, const PriceRecord *end) {
+    return find_invalid_records(begin, end, [](const PriceRecord &record) {
+        return static_cast<uint8_t>(!(record.price > 0) | !(record.volume >= 0));
+    });
+}
+
+std::vector<size_t> find_invalid_ohlc_ticks(const OhlcTick *begin, const OhlcTick *end) {
+    return find_invalid_records(begin, end, [](const OhlcTick &ohlc_tick) {
+        return static_cast<uint8_t>(!(ohlc_tick.low > 0) | !(ohlc_tick.low <= ohlc_tick.open) |
+                                    !(ohlc_tick.low <= ohlc_tick.close) | !(ohlc_tick.high >= ohlc_tick.open) |
+                                    !(ohlc_tick.high >= ohlc_tick.close) | !(ohlc_tick.volume >= 0));
+    });
+}
+
 /*
 As exchange api can be unresponsive there are gaps in (T,P,V).
 Ex:-
@@ -74,62 +115,133 @@ std::vector<HistoryGap> get_price_history_gap(PriceHistory::const_iterator begin
     return std::vector<HistoryGap>(history_gaps_result.rbegin(), history_gaps_result.rend());
 }
 
-PriceHistory clean_outliers(PriceHistory::const_iterator begin, PriceHistory::const_iterator end,
-                            float max_price_deviation_per_min, std::vector<size_t> *outlier_indexes) {
-    // TODO :- check for null outlier_indexes and return stop with error
-    static constexpr int MAX_LOOKAHEAD = 10;
-    static constexpr int MIN_LOOKAHEAD_PERSISTENT = 3;
-    PriceHistory price_history_result;
-    for (auto it = begin; it != end; ++it) {
-        const PriceRecord &price_record = *it;
-        const size_t price_record_index = std::distance(begin, it);
+OutlierFilter::OutlierFilter(float max_price_deviation_per_min, std::vector<size_t> *outlier_indexes)
+    : _max_price_deviation_per_min(max_price_deviation_per_min), _outlier_indexes(outlier_indexes),
+      _window(2 * MAX_LOOKAHEAD) {
+    // mask wrap around needs power of 2 capacity
+    size_t capacity = 1;
+    while (capacity < _window.size())
+        capacity <<= 1;
+    _window.resize(capacity);
+}
+
+void OutlierFilter::add_outlier(size_t index) {
+    if (_outlier_indexes != nullptr)
+        _outlier_indexes->push_back(index);
+}
+
+void OutlierFilter::push(const PriceRecord &price_record) {
+    assert(!_finished);
+    // Window can only overflow with long run of invalid records, grow it unwrapped in that case.
+    if (_window_size == _window.size()) {
+        std::vector<PendingRecord> window(2 * _window.size());
+        for (size_t i = 0; i < _window_size; ++i)
+            window[i] = window_at(i);
+        _window.swap(window);
+        _window_begin = 0;
+    }
+    _window[(_window_begin + _window_size) & (_window.size() - 1)] = {_next_index++, price_record};
+    ++_window_size;
+    if (is_lookahead_record(price_record))
+        ++_window_lookahead_size;
+}
+
+void OutlierFilter::finish() { _finished = true; }
+
+void OutlierFilter::resume_after(const PriceRecord &last_price_record) {
+    assert(_next_index == 0);
+    _price_record_prev = last_price_record;
+    _has_price_record_prev = true;
+}
+
+void OutlierFilter::pop_window_front() {
+    if (is_lookahead_record(window_at(0).price_record))
+        --_window_lookahead_size;
+    _window_begin = (_window_begin + 1) & (_window.size() - 1);
+    --_window_size;
+}
+
+bool OutlierFilter::pop(PriceRecord &price_record_result) {
+    while (_window_size > 0) {
+        const PendingRecord &pending = window_at(0);
+        const PriceRecord &price_record = pending.price_record;
         // if price is less than or equal to 0 or volume was zero consider that as outlier and remove it from dataset
         if (price_record.price <= 0 || price_record.volume <= 0) {
-            outlier_indexes->push_back(price_record_index);
+            add_outlier(pending.index);
+            pop_window_front();
             continue;
         }
 
         // if price record is not outlier push that to result and look ahead for max_price_deviation
-        if (price_history_result.empty()) {
-            price_history_result.push_back(price_record);
-            continue;
+        if (!_has_price_record_prev) {
+            _price_record_prev = price_record;
+            _has_price_record_prev = true;
+            price_record_result = price_record;
+            pop_window_front();
+            return true;
         }
 
         /*Try to detect if price change happen that's natural or outlier. we look head in data set (coming more price
          * TPV) if this change is valid with defined price deviation permin */
-        const PriceRecord &price_record_prev = price_history_result.back();
-        const float reference_price = price_record_prev.price;
+        const float reference_price = _price_record_prev.price;
         const float duration_min =
-            std::max(1.0f, static_cast<float>(price_record.timestamp_sec - price_record_prev.timestamp_sec) / 60.0f);
-        const float change_factor = (1.0f + max_price_deviation_per_min) * std::sqrt(duration_min);
+            std::max(1.0f, static_cast<float>(price_record.timestamp_sec - _price_record_prev.timestamp_sec) / 60.0f);
+        const float change_factor = (1.0f + _max_price_deviation_per_min) * std::sqrt(duration_min);
         const float change_up_price = reference_price * change_factor;
         const float change_down_price = reference_price / change_factor;
         const bool changed_up = price_record.price > change_up_price;
         const bool changed_down = price_record.price < change_down_price;
         bool is_outlier = false;
         if (changed_up || changed_down) {
+            // record itself is a lookahead record (it passed the check above) so rest of the window is after it
+            if (!_finished && _window_lookahead_size - 1 < static_cast<size_t>(MAX_LOOKAHEAD)) {
+                // wait until there is enough to look ahead
+                return false;
+            }
             // look ahead in data if price change persist
             int lookahead = 0;
             int lookahead_persistent = 0;
             const float middle_up_price = 0.8f * change_up_price + 0.2f * reference_price;
             const float middle_down_price = 0.8f * change_down_price + 0.2f * reference_price;
-            for (auto jt = it + 1; jt != end && lookahead < MAX_LOOKAHEAD; ++jt) {
-                if (jt->price <= 0 || jt->volume < 0) {
+            for (size_t j = 1; j < _window_size && lookahead < MAX_LOOKAHEAD; ++j) {
+                const PriceRecord &lookahead_record = window_at(j).price_record;
+                if (!is_lookahead_record(lookahead_record)) {
                     continue;
                 }
-                if ((changed_up && jt->price > middle_up_price) || (changed_down && jt->price < middle_down_price)) {
+                if ((changed_up && lookahead_record.price > middle_up_price) ||
+                    (changed_down && lookahead_record.price < middle_down_price)) {
                     ++lookahead_persistent;
                 }
                 ++lookahead;
             }
             is_outlier = lookahead_persistent < MIN_LOOKAHEAD_PERSISTENT;
         }
-        if (!is_outlier) {
-            price_history_result.push_back(price_record);
-        } else if (outlier_indexes != nullptr) {
-            outlier_indexes->push_back(price_record_index);
+        if (is_outlier) {
+            add_outlier(pending.index);
+            pop_window_front();
+            continue;
         }
+        _price_record_prev = price_record;
+        price_record_result = price_record;
+        pop_window_front();
+        return true;
     }
+    return false;
+}
+
+PriceHistory clean_outliers(PriceHistory::const_iterator begin, PriceHistory::const_iterator end,
+                            float max_price_deviation_per_min, std::vector<size_t> *outlier_indexes) {
+    PriceHistory price_history_result;
+    OutlierFilter outlier_filter(max_price_deviation_per_min, outlier_indexes);
+    PriceRecord price_record;
+    for (auto it = begin; it != end; ++it) {
+        outlier_filter.push(*it);
+        while (outlier_filter.pop(price_record))
+            price_history_result.push_back(price_record);
+    }
+    outlier_filter.finish();
+    while (outlier_filter.pop(price_record))
+        price_history_result.push_back(price_record);
     return price_history_result;
 }
 
@@ -155,61 +267,243 @@ std::map<size_t, bool> get_outlier_indexes_with_context(const std::vector<size_t
     return index_to_outlier;
 }
 
-OhlcHistory update_data_frequency(PriceHistory::const_iterator begin, PriceHistory::const_iterator end,
-                                  int interval_rate_sec) {
-    OhlcHistory altered_ohlc_history;
-    for (auto it = begin; it != end; ++it) {
-        /* Find which interval current time stamp belong.
-         ex:- if sampling rate is 5 min or 300sec.
-           1234 =1234 - (1234 % 300) = 1200
-           1250 =1250 - (1250 % 300) = 1200
-           1290 =1290 - (1290 % 300) = 1200
-           1400 =1400 - (1400 % 300) = 1200
-           1580 =1580 - (1580 % 300) = 1500 <= in the next range
-        */
-        const int64_t lower_frequency_timestamp_sec = it->timestamp_sec - (it->timestamp_sec % interval_rate_sec);
-
-        /* if new price history comes up but previous history have gap (missing data) fill it with zero volume, with
-         * previous OHLC. Before adding the new price history.*/
-        while (!altered_ohlc_history.empty() &&
-               altered_ohlc_history.back().timestamp_sec + interval_rate_sec < lower_frequency_timestamp_sec) {
-            const int64_t prev_timestamp_sec = altered_ohlc_history.back().timestamp_sec;
-            const float prev_close = altered_ohlc_history.back().close;
-            altered_ohlc_history.emplace_back();
-            OhlcTick *ohlc_tick = &altered_ohlc_history.back();
-
-            ohlc_tick->timestamp_sec = prev_timestamp_sec + interval_rate_sec;
-            ohlc_tick->open = prev_close;
-            ohlc_tick->high = prev_close;
-            ohlc_tick->low = prev_close;
-            ohlc_tick->close = prev_close;
-            ohlc_tick->volume = 0;
+void OhlcHistoryBuilder::push(const PriceRecord &price_record) {
+    add(price_record.timestamp_sec, price_record.price, price_record.price, price_record.price, price_record.price,
+        price_record.volume);
+}
+
+void OhlcHistoryBuilder::push(const OhlcTick &ohlc_tick) {
+    add(ohlc_tick.timestamp_sec, ohlc_tick.open, ohlc_tick.high, ohlc_tick.low, ohlc_tick.close, ohlc_tick.volume);
+}
+
+void OhlcHistoryBuilder::close_last() {
+    if (_ohlc_history.empty() || _skip_passing_last)
+        return;
+    const OhlcTick closed_ohlc_tick = _ohlc_history.back();
+    for (OhlcHistoryBuilder *coarser_builder : _coarser_builders)
+        coarser_builder->push(closed_ohlc_tick);
+}
+
+void OhlcHistoryBuilder::resume_coarser_builders() {
+    if (_ohlc_history.empty())
+        return;
+    for (OhlcHistoryBuilder *coarser_builder : _coarser_builders) {
+        OhlcHistory &coarser_ohlc_history = coarser_builder->_ohlc_history;
+        if (coarser_ohlc_history.empty())
+            continue;
+        const int64_t last_timestamp_sec = coarser_ohlc_history.back().timestamp_sec;
+        coarser_ohlc_history.pop_back();
+        // Ticks before the last one were closed and are in the history already, they must not be pushed on
+        OhlcHistoryBuilder last_tick_builder(coarser_builder->_interval_rate_sec, coarser_ohlc_history);
+        for (size_t i = 1; i + 1 < _ohlc_history.size(); ++i) {
+            const OhlcTick &ohlc_tick = _ohlc_history[i];
+            const float prev_close = _ohlc_history[i - 1].close;
+            const bool is_gap_fill = ohlc_tick.volume == 0 && ohlc_tick.open == prev_close &&
+                                     ohlc_tick.high == prev_close && ohlc_tick.low == prev_close &&
+                                     ohlc_tick.close == prev_close;
+            if (ohlc_tick.timestamp_sec >= last_timestamp_sec && !is_gap_fill)
+                last_tick_builder.push(ohlc_tick);
         }
+        // Without closed ticks within the last interval, history ends with tick which previous run already passed on
+        coarser_builder->_skip_passing_last =
+            coarser_ohlc_history.empty() || coarser_ohlc_history.back().timestamp_sec < last_timestamp_sec;
+    }
+}
+
+void OhlcHistoryBuilder::finish() {
+    close_last();
+    for (OhlcHistoryBuilder *coarser_builder : _coarser_builders)
+        coarser_builder->finish();
+}
+
+void OhlcHistoryBuilder::add(int64_t timestamp_sec, float open, float high, float low, float close, float volume) {
+    /* Find which interval current time stamp belong.
+     ex:- if sampling rate is 5 min or 300sec.
+       1234 =1234 - (1234 % 300) = 1200
+       1250 =1250 - (1250 % 300) = 1200
+       1290 =1290 - (1290 % 300) = 1200
+       1400 =1400 - (1400 % 300) = 1200
+       1580 =1580 - (1580 % 300) = 1500 <= in the next range
+    */
+    const int64_t lower_frequency_timestamp_sec = timestamp_sec - (timestamp_sec % _interval_rate_sec);
+
+    /* if new price history comes up but previous history have gap (missing data) fill it with zero volume, with
+     * previous OHLC. Before adding the new price history.*/
+    while (!_ohlc_history.empty() &&
+           _ohlc_history.back().timestamp_sec + _interval_rate_sec < lower_frequency_timestamp_sec) {
+        close_last();
+        const int64_t prev_timestamp_sec = _ohlc_history.back().timestamp_sec;
+        const float prev_close = _ohlc_history.back().close;
+        _ohlc_history.emplace_back();
+        OhlcTick *ohlc_tick = &_ohlc_history.back();
+        _skip_passing_last = true;
+
+        ohlc_tick->timestamp_sec = prev_timestamp_sec + _interval_rate_sec;
+        ohlc_tick->open = prev_close;
+        ohlc_tick->high = prev_close;
+        ohlc_tick->low = prev_close;
+        ohlc_tick->close = prev_close;
+        ohlc_tick->volume = 0;
+    }
 
-        /*If last ohlc is in previous downsampled time range. Insert new entry, Else update the last entry*/
-        if (altered_ohlc_history.empty() || altered_ohlc_history.back().timestamp_sec < lower_frequency_timestamp_sec) {
-            altered_ohlc_history.emplace_back();
-            OhlcTick *ohlc_tick = &altered_ohlc_history.back();
-
-            ohlc_tick->timestamp_sec = lower_frequency_timestamp_sec;
-            ohlc_tick->open = it->price;
-            ohlc_tick->high = it->price;
-            ohlc_tick->low = it->price;
-            ohlc_tick->close = it->price;
-            ohlc_tick->volume = it->volume;
+    /*If last ohlc is in previous downsampled time range. Insert new entry, Else update the last entry*/
+    if (_ohlc_history.empty() || _ohlc_history.back().timestamp_sec < lower_frequency_timestamp_sec) {
+        close_last();
+        _ohlc_history.emplace_back();
+        OhlcTick *ohlc_tick = &_ohlc_history.back();
+        _skip_passing_last = false;
+
+        ohlc_tick->timestamp_sec = lower_frequency_timestamp_sec;
+        ohlc_tick->open = open;
+        ohlc_tick->high = high;
+        ohlc_tick->low = low;
+        ohlc_tick->close = close;
+        ohlc_tick->volume = volume;
+    } else {
+        assert(_ohlc_history.back().timestamp_sec == lower_frequency_timestamp_sec);
+        OhlcTick *ohlc_tick = &_ohlc_history.back();
+
+        /// Hight would be max of price in that range
+        ohlc_tick->high = std::max(ohlc_tick->high, high);
+        // low would be min of all price in that range
+        ohlc_tick->low = std::min(ohlc_tick->low, low);
+        ohlc_tick->close = close;
+        ohlc_tick->volume = ohlc_tick->volume + volume;
+    }
+}
+
+OhlcHistoriesBuilder::OhlcHistoriesBuilder(const std::vector<int> &interval_rates_sec,
+                                           std::vector<OhlcHistory> &ohlc_histories) {
+    ohlc_histories.resize(interval_rates_sec.size());
+    // builders keep pointers to each other so it must not reallocate
+    _builders.reserve(interval_rates_sec.size());
+    for (size_t i = 0; i < interval_rates_sec.size(); ++i) {
+        assert(interval_rates_sec[i] > 0);
+        _builders.emplace_back(interval_rates_sec[i], ohlc_histories[i]);
+    }
+    for (OhlcHistoryBuilder &builder : _builders) {
+        // largest finer interval which divides this one
+        OhlcHistoryBuilder *finer_builder = nullptr;
+        for (OhlcHistoryBuilder &candidate : _builders) {
+            if (candidate.interval_rate_sec() < builder.interval_rate_sec() &&
+                builder.interval_rate_sec() % candidate.interval_rate_sec() == 0 &&
+                (finer_builder == nullptr || candidate.interval_rate_sec() > finer_builder->interval_rate_sec())) {
+                finer_builder = &candidate;
+            }
+        }
+        if (finer_builder != nullptr) {
+            finer_builder->add_coarser_builder(&builder);
         } else {
-            assert(altered_ohlc_history.back().timestamp_sec == lower_frequency_timestamp_sec);
-            OhlcTick *ohlc_tick = &altered_ohlc_history.back();
-
-            /// Hight would be max of price in that range
-            ohlc_tick->high = std::max(ohlc_tick->high, it->price);
-            // low would be min of all price in that range
-            ohlc_tick->low = std::min(ohlc_tick->low, it->price);
-            ohlc_tick->close = it->price;
-            ohlc_tick->volume = ohlc_tick->volume + it->volume;
+            _root_builders.push_back(&builder);
         }
     }
+}
+
+void OhlcHistoriesBuilder::push(const PriceRecord &price_record) {
+    for (OhlcHistoryBuilder *root_builder : _root_builders)
+        root_builder->push(price_record);
+}
+
+void OhlcHistoriesBuilder::resume() {
+    // Coarser histories first, they are rebuilt from the closed ticks of finer ones before those are rebuilt
+    std::vector<OhlcHistoryBuilder *> builders;
+    for (OhlcHistoryBuilder &builder : _builders)
+        builders.push_back(&builder);
+    std::sort(builders.begin(), builders.end(), [](const OhlcHistoryBuilder *lhs, const OhlcHistoryBuilder *rhs) {
+        return lhs->interval_rate_sec() > rhs->interval_rate_sec();
+    });
+    for (OhlcHistoryBuilder *builder : builders)
+        builder->resume_coarser_builders();
+}
+
+void OhlcHistoriesBuilder::finish() {
+    for (OhlcHistoryBuilder *root_builder : _root_builders)
+        root_builder->finish();
+}
+
+OhlcHistory update_data_frequency(PriceHistory::const_iterator begin, PriceHistory::const_iterator end,
+                                  int interval_rate_sec) {
+    OhlcHistory altered_ohlc_history;
+    OhlcHistoryBuilder ohlc_history_builder(interval_rate_sec, altered_ohlc_history);
+    for (auto it = begin; it != end; ++it) {
+        ohlc_history_builder.push(*it);
+    }
     return altered_ohlc_history;
 }
 
-} // namespace back_trader
\ No newline at end of file
+std::vector<OhlcHistory> update_data_frequency(PriceHistory::const_iterator begin, PriceHistory::const_iterator end,
+                                               const std::vector<int> &interval_rates_sec) {
+    std::vector<OhlcHistory> altered_ohlc_histories;
+    OhlcHistoriesBuilder ohlc_histories_builder(interval_rates_sec, altered_ohlc_histories);
+    for (auto it = begin; it != end; ++it) {
+        ohlc_histories_builder.push(*it);
+    }
+    ohlc_histories_builder.finish();
+    return altered_ohlc_histories;
+}
+
+std::vector<OhlcHistory> clean_outliers_and_update_data_frequency(PriceHistory::const_iterator begin,
+                                                                  PriceHistory::const_iterator end,
+                                                                  float max_price_deviation_per_min,
+                                                                  const std::vector<int> &interval_rates_sec,
+                                                                  std::vector<size_t> *outlier_indexes) {
+    std::vector<OhlcHistory> ohlc_histories;
+    OhlcHistoriesBuilder ohlc_histories_builder(interval_rates_sec, ohlc_histories);
+    OutlierFilter outlier_filter(max_price_deviation_per_min, outlier_indexes);
+    PriceRecord price_record;
+    for (auto it = begin; it != end; ++it) {
+        outlier_filter.push(*it);
+        while (outlier_filter.pop(price_record))
+            ohlc_histories_builder.push(price_record);
+    }
+    outlier_filter.finish();
+    while (outlier_filter.pop(price_record))
+        ohlc_histories_builder.push(price_record);
+    ohlc_histories_builder.finish();
+    return ohlc_histories;
+}
+
+size_t append_clean_outliers_and_update_data_frequency(PriceHistory::const_iterator begin,
+                                                       PriceHistory::const_iterator end,
+                                                       int64_t last_source_timestamp_sec,
+                                                       float max_price_deviation_per_min,
+                                                       const std::vector<int> &interval_rates_sec,
+                                                       std::vector<OhlcHistory> &ohlc_histories,
+                                                       std::vector<size_t> *outlier_indexes) {
+    assert(ohlc_histories.size() == interval_rates_sec.size());
+    PriceRecord last_price_record{last_source_timestamp_sec, 0.0f, 0.0f};
+    for (const OhlcHistory &ohlc_history : ohlc_histories) {
+        if (!ohlc_history.empty())
+            last_price_record.price = ohlc_history.back().close;
+    }
+    OhlcHistoriesBuilder ohlc_histories_builder(interval_rates_sec, ohlc_histories);
+    ohlc_histories_builder.resume();
+
+    OutlierFilter outlier_filter(max_price_deviation_per_min, outlier_indexes);
+    if (last_price_record.price > 0)
+        outlier_filter.resume_after(last_price_record);
+    // Records within the last (open) OHLC tick up to the last source record were already aggregated into it
+    auto it = begin;
+    while (it != end && it->timestamp_sec <= last_source_timestamp_sec)
+        ++it;
+    const size_t skipped_records = static_cast<size_t>(std::distance(begin, it));
+    const size_t first_outlier = outlier_indexes != nullptr ? outlier_indexes->size() : 0;
+    PriceRecord price_record;
+    for (; it != end; ++it) {
+        outlier_filter.push(*it);
+        while (outlier_filter.pop(price_record))
+            ohlc_histories_builder.push(price_record);
+    }
+    outlier_filter.finish();
+    while (outlier_filter.pop(price_record))
+        ohlc_histories_builder.push(price_record);
+    ohlc_histories_builder.finish();
+    // outlier filter counts from the first pushed record, outlier indexes are from begin
+    if (outlier_indexes != nullptr) {
+        for (size_t i = first_outlier; i < outlier_indexes->size(); ++i)
+            (*outlier_indexes)[i] += skipped_records;
+    }
+    return skipped_records;
+}
+
+} // namespace back_trader
@@ -14,6 +14,14 @@ std::vector<HistoryGap> get_price_history_gap(PriceHistory::const_iterator begin
                                               int64_t start_timestamp_sec,        // nowrap
                                               int64_t end_timestamp_sec, size_t top_n);
 
+/* Returns indexes (from begin) of price records with non positive price or negative volume. All records are checked in
+ one branchless pass so it can be vectorized, every invalid record is reported not just the first one. */
+std::vector<size_t> find_invalid_price_records(const PriceRecord *begin, const PriceRecord *end);
+
+/* Returns indexes (from begin) of OHLC ticks which break 0 < low <= open, close <= high or have negative volume. Same
+ bulk pass as find_invalid_price_records. */
+std::vector<size_t> find_invalid_ohlc_ticks(const OhlcTick *begin, const OhlcTick *end);
+
 /* Returns price history with removed outliers.
 max_price_deviation_per_min is maximum allowed price deviation per minute.
 outlier_indexes is an optional output vector of removed outlier indexes which is accumulated.
@@ -39,4 +47,154 @@ std::map<size_t, bool> get_outlier_indexes_with_context(const std::vector<size_t
 OhlcHistory update_data_frequency(PriceHistory::const_iterator begin, // nowrap
                                   PriceHistory::const_iterator end,   // nowrap
                                   int interval_rate_sec);
+
+/* Returns the updated intervaled OHLC histories for every given rate (in seconds) in one pass over the price history.
+ See OhlcHistoriesBuilder for how coarser intervals are derived from finer ones. */
+std::vector<OhlcHistory> update_data_frequency(PriceHistory::const_iterator begin, // nowrap
+                                               PriceHistory::const_iterator end,   // nowrap
+                                               const std::vector<int> &interval_rates_sec);
+
+/* Returns the OHLC histories (one for every interval rate) of price history with removed outliers in a single pass.
+ Same as update_data_frequency over the result of clean_outliers but cleaned price history is never materialised,
+ every price record flows from outlier filter straight into OHLC ticks it belongs to. */
+std::vector<OhlcHistory> clean_outliers_and_update_data_frequency(PriceHistory::const_iterator begin,        // nowrap
+                                                                  PriceHistory::const_iterator end,          // nowrap
+                                                                  float max_price_deviation_per_min,         // nowrap
+                                                                  const std::vector<int> &interval_rates_sec, // nowrap
+                                                                  std::vector<size_t> *outlier_indexes);
+
+/* Appends OHLC ticks of new price records to ohlc_histories (one for every interval rate) which hold the last OHLC
+ ticks of the histories built so far (see OhlcHistoriesBuilder::resume). Last OHLC tick is still open, price records
+ within its interval update it. Price records up to last_source_timestamp_sec (the last price record the history was
+ built from) are already in the history and skipped, returns how many of them. Outlier filter continues from the close
+ of the last OHLC tick (last price record which wasn't an outlier), so the first new records are checked against it
+ and histories are the same as a single run of clean_outliers_and_update_data_frequency over the whole history. */
+size_t append_clean_outliers_and_update_data_frequency(PriceHistory::const_iterator begin,         // nowrap
+                                                       PriceHistory::const_iterator end,           // nowrap
+                                                       int64_t last_source_timestamp_sec,          // nowrap
+                                                       float max_price_deviation_per_min,          // nowrap
+                                                       const std::vector<int> &interval_rates_sec, // nowrap
+                                                       std::vector<OhlcHistory> &ohlc_histories,   // nowrap
+                                                       std::vector<size_t> *outlier_indexes);
+
+/*
+ Streaming outlier filter (clean_outliers is built on it). Price records are pushed in order and come out of pop once
+ it's decided that they are not outliers. Deciding about a sudden price change needs to look ahead MAX_LOOKAHEAD valid
+ records, so records wait in a small ring buffer (the lookahead window) until enough of follow-up records are pushed or
+ finish is called.
+*/
+class OutlierFilter {
+  public:
+    static constexpr int MAX_LOOKAHEAD = 10;
+    static constexpr int MIN_LOOKAHEAD_PERSISTENT = 3;
+
+    /* max_price_deviation_per_min is maximum allowed price deviation per minute. outlier_indexes is an optional
+     output vector of removed outlier indexes (index of pushed record) which is accumulated.*/
+    OutlierFilter(float max_price_deviation_per_min, std::vector<size_t> *outlier_indexes);
+
+    // Push the next price record of the history.
+    void push(const PriceRecord &price_record);
+
+    // No more price records are going to be pushed, decide about everything left in the lookahead window.
+    void finish();
+
+    /* Continue filtering after history which was already filtered, last_price_record is the last record which wasn't
+     an outlier. Has to be called before the first push.*/
+    void resume_after(const PriceRecord &last_price_record);
+
+    /* Sets price_record to the next record which is not an outlier. Returns false if there isn't any decided yet.*/
+    bool pop(PriceRecord &price_record);
+
+  private:
+    struct PendingRecord {
+        size_t index;
+        PriceRecord price_record;
+    };
+    float _max_price_deviation_per_min;
+    std::vector<size_t> *_outlier_indexes;
+    // Last not outlier record, every price change is compared against it.
+    PriceRecord _price_record_prev{};
+    bool _has_price_record_prev = false;
+    bool _finished = false;
+    size_t _next_index = 0;
+    // Lookahead window as ring buffer, capacity is power of 2 so it's wrapped around with a mask.
+    std::vector<PendingRecord> _window;
+    size_t _window_begin = 0;
+    size_t _window_size = 0;
+    // Number of records in the window which can be used for lookahead (positive price and non negative volume).
+    size_t _window_lookahead_size = 0;
+
+    static bool is_lookahead_record(const PriceRecord &price_record) {
+        return price_record.price > 0 && price_record.volume >= 0;
+    }
+    const PendingRecord &window_at(size_t i) const { return _window[(_window_begin + i) & (_window.size() - 1)]; }
+    void pop_window_front();
+    void add_outlier(size_t index);
+};
+
+/* Streaming version of update_data_frequency. Price records (or closed OHLC ticks of a finer interval) are pushed in
+ order and OHLC ticks of interval_rate_sec are appended (or the last one updated) to ohlc_history as they come. Missing
+ intervals are filled with zero volume tick of the previous close. */
+class OhlcHistoryBuilder {
+  public:
+    OhlcHistoryBuilder(int interval_rate_sec, OhlcHistory &ohlc_history)
+        : _interval_rate_sec(interval_rate_sec), _ohlc_history(ohlc_history) {}
+
+    void push(const PriceRecord &price_record);
+
+    /* Aggregate closed OHLC tick of a finer interval (interval_rate_sec has to be a multiple of it). Gap fill ticks of
+     the finer interval are never pushed, this history fills its own gaps. */
+    void push(const OhlcTick &ohlc_tick);
+
+    // No more records are going to be pushed, the last OHLC tick is closed.
+    void finish();
+
+    /* OHLC ticks of this history are passed to coarser_builder as they close (except gap fill ticks). */
+    void add_coarser_builder(OhlcHistoryBuilder *coarser_builder) { _coarser_builders.push_back(coarser_builder); }
+
+    /* Histories hold the last OHLC ticks of a previous run, the last tick of every coarser history is rebuilt from the
+     closed ticks of this history within it (as it was before the last tick of this history was closed). Has to be
+     called before the last tick of this history is rebuilt from its finer history. */
+    void resume_coarser_builders();
+
+    int interval_rate_sec() const { return _interval_rate_sec; }
+
+  private:
+    int _interval_rate_sec;
+    OhlcHistory &_ohlc_history;
+    std::vector<OhlcHistoryBuilder *> _coarser_builders;
+    /* True when the last OHLC tick in history isn't passed to coarser builders when it closes, zero volume gap fill or
+     tick closed by a previous run (see resume_coarser_builders). */
+    bool _skip_passing_last = false;
+
+    void add(int64_t timestamp_sec, float open, float high, float low, float close, float volume);
+    // Last OHLC tick won't change anymore, pass it to coarser builders.
+    void close_last();
+};
+
+/*
+ Builds OHLC histories of several interval rates in one pass. Only the intervals which don't have any finer divisor in
+ the list are built from price records, the rest are aggregated from closed OHLC ticks of the largest finer interval
+ that divides them (ex:- for 5min, 30min and 1h, 30min is built from 5min and 1h from 30min ticks).
+ Open, high, low and close are the same as building every interval from price records, volume is summed from finer
+ volumes so it can differ in the last float digit.
+*/
+class OhlcHistoriesBuilder {
+  public:
+    // ohlc_histories[i] is the history of interval_rates_sec[i], it's resized to number of intervals.
+    OhlcHistoriesBuilder(const std::vector<int> &interval_rates_sec, std::vector<OhlcHistory> &ohlc_histories);
+
+    void push(const PriceRecord &price_record);
+
+    /* Continues the histories of a previous run, they hold its last OHLC ticks (at least the ticks within the last tick
+     of the coarsest interval and the tick before them). See OhlcHistoryBuilder::resume_coarser_builders. */
+    void resume();
+
+    void finish();
+
+  private:
+    std::vector<OhlcHistoryBuilder> _builders;
+    // Builders which are fed from price records.
+    std::vector<OhlcHistoryBuilder *> _root_builders;
+};
 } // namespace back_trader
\ No newline at end of file
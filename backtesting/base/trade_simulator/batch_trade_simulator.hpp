@@ -0,0 +1,68 @@
+#pragma once
+#include "../common_interface/common.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace back_trader {
+/*
+ Orders emitted by the lanes of a BatchTradeSimulator. Every lane owns max_orders_per_lane consecutive slots of orders,
+ order_counts[lane] of them are in use.
+*/
+struct BatchOrders {
+    size_t max_orders_per_lane = 0;
+    std::vector<Order> orders;
+    std::vector<uint8_t> order_counts;
+
+    void resize(size_t lane_count, size_t max_orders) {
+        max_orders_per_lane = max_orders;
+        orders.assign(lane_count * max_orders, Order{});
+        order_counts.assign(lane_count, 0);
+    }
+
+    void clear() { std::fill(order_counts.begin(), order_counts.end(), 0); }
+
+    const Order *lane_begin(size_t lane) const { return orders.data() + lane * max_orders_per_lane; }
+    const Order *lane_end(size_t lane) const { return lane_begin(lane) + order_counts[lane]; }
+
+    Order &emplace_back(size_t lane) { return orders[lane * max_orders_per_lane + order_counts[lane]++]; }
+};
+
+/*
+ Runs many simulators of the same strategy (with different configurations) in lockstep. Every simulator is a lane,
+ its state is kept in per field arrays (structure of arrays) so one update walks all lanes in tight loops which can be
+ vectorized, instead of one virtual TradeSimulator::update per simulator per OHLC tick.
+ Every lane must emit exactly the same orders as the TradeSimulator of its configuration would, so the results of the
+ batch execution stay bit identical to executing the simulators one by one.
+*/
+class BatchTradeSimulator {
+  public:
+    BatchTradeSimulator() {}
+    virtual ~BatchTradeSimulator() {}
+
+    // Number of lanes (simulators).
+    virtual size_t size() const = 0;
+
+    // Maximum number of orders emitted by a lane on single update.
+    virtual size_t max_orders_per_lane() const = 0;
+
+    /*
+      Same as TradeSimulator::update for every lane. base_balances and quote_balances are the account balances of the
+      lanes. Orders of the lanes are appended to orders which is cleared by the caller.
+    */
+    virtual void update(const OhlcTick &ohlc_tick,   // nowrap
+                        const float *base_balances,  // nowrap
+                        const float *quote_balances, // nowrap
+                        BatchOrders &orders) = 0;
+
+    /*
+     Event skipping (optional), same as TradeSimulator::can_skip for the whole batch. Returns true only if every lane
+     can skip the ticks within ohlc_range, a lane that has to be updated keeps all the lanes updated.
+    */
+    virtual bool can_skip(const OhlcRange &ohlc_range) const { return false; }
+
+    // Same as TradeSimulator::skip for every lane.
+    virtual void skip(const OhlcTick &last_tick) {}
+};
+} // namespace back_trader
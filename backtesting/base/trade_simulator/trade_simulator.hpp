@@ -1,7 +1,10 @@
 
 #pragma once
+#include "batch_trade_simulator.hpp"
 #include <base_header.hpp>
 #include <memory>
+#include <ostream>
+#include <vector>
 namespace back_trader {
 
 /*
@@ -27,6 +30,9 @@ Every order gets either executed or canceled by the exchange at each step. This
 simplifies the process, eliminating the need for the simulator to maintain active orders over time. In practical
 applications, orders would not be canceled if they are to be re-emitted; instead, existing orders would be modified
 based on the updated state.
+Simulators keeping many orders over time (ex:- grid of limit orders) can instead return non zero max_resting_orders,
+the exchange then attaches an OrderBook to them, orders placed into it stay active (and get partially filled) until
+they're filled or cancelled by the simulator. Book orders are executed before the emitted orders.
 
 Moreover, the sampling rate of the OHLC history defines how frequently the simulator is updated and emits orders.
 Their behavior and performance should remain consistent regardless of how often they are called. This is crucial because
@@ -34,7 +40,10 @@ exchanges (or their APIs) can become unresponsive for random periods, resulting
 it is encouraged to test the TradeSimulator on OHLC histories with varying sampling rates and gaps.
  */
 
-// TODO use CRTP to remove virtual methods
+/*
+ Simulation loop calls update directly on the final strategy class (see SimulatorDispatcher::execute_simulation), the
+ virtual methods are only used when a simulator is executed through this interface.
+*/
 class TradeSimulator {
   public:
     TradeSimulator(){};
@@ -43,8 +52,8 @@ class TradeSimulator {
       Updates the (internal) trader state and emits zero or more orders.
       We assume that "orders" is not null and points to an empty vector.
       This method is called consecutively (by the exchange) on every OHLC tick.
-      Trader can assume that there are no active orders when this method is
-      called. The emitted orders will be either executed or cancelled by the
+      Trader can assume that there are no active orders (except the ones in
+      its OrderBook) when this method is called. The emitted orders will be either executed or cancelled by the
       exchange at the next OHLC tick.
     */
     virtual void update(const OhlcTick &ohlc_tick,                              // nowrap
@@ -52,10 +61,32 @@ class TradeSimulator {
                         float base_balance,                                     // nowrap
                         float quote_balance,                                    // nowrap
                         std::vector<Order> &orders) = 0;
-    // Returns the internal TradeSimulator state (as a string).
-    virtual std::string get_internal_state() const = 0;
+    // Writes the internal TradeSimulator state (single line without end of line), no allocation on the way.
+    virtual void write_internal_state(std::ostream &os) const = 0;
+
+    // Maximum number of good till cancelled orders the simulator keeps in OrderBook, 0 if it doesn't use one.
+    virtual size_t max_resting_orders() const { return 0; }
+
+    // Called before the first update when max_resting_orders is not 0, the book is valid during the whole simulation.
+    virtual void attach_order_book(OrderBook *order_book) {}
+
+    /*
+     Event skipping (optional). Returns true if on OHLC ticks (following the last update) within ohlc_range none of the
+     emitted orders gets triggered and update would only remember the tick (same state and orders). The executor then
+     skips execution and update over such ticks and calls skip with the last skipped tick with volume instead.
+     Resting orders of the OrderBook are executed on every tick, the executor doesn't skip while the book isn't empty.
+    */
+    virtual bool can_skip(const OhlcRange &ohlc_range) const { return false; }
+
+    // Same as update on skipped ticks up to last_tick (see can_skip).
+    virtual void skip(const OhlcTick &last_tick) {}
 };
 
+// Defined in execution/simulation_types.hpp and logs/simulation_log.hpp.
+struct SimulationResult;
+struct EvaluationPeriod;
+class SimulationLogger;
+
 // It can emit a new instance of the same simulator (with the same configuration) whenever needed.
 class SimulatorDispatcher {
   public:
@@ -70,5 +101,24 @@ class SimulatorDispatcher {
 
     // Returns a new instance of a TradeSimulator
     virtual std::unique_ptr<TradeSimulator> new_simulator() const = 0;
+
+    /*
+     Executes a new simulator on evaluation period with execute_trade_simulation specialized for the simulator
+     type, so its update is inlined into the simulation loop. logger may be null.
+    */
+    virtual SimulationResult execute_simulation(const AccountConfig &account_config,       // nowrap
+                                                const EvaluationPeriod &evaluation_period, // nowrap
+                                                const FearAndGreed *fear_and_greed_input,  // nowrap
+                                                bool fast_execute,                         // nowrap
+                                                SimulationLogger *logger) const = 0;
+
+    /*
+     Returns a BatchTradeSimulator with a lane for every dispatcher of simulator_dispatchers (in the same order), or
+     nullptr if the strategy has no batched version or the dispatchers are not all of the same strategy.
+    */
+    virtual std::unique_ptr<BatchTradeSimulator>
+    new_batch_simulator(const std::vector<const SimulatorDispatcher *> &simulator_dispatchers) const {
+        return nullptr;
+    }
 };
 } // namespace back_trader
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace back_trader {
+// Alignment of columnar data (OhlcColumns, batch simulator lanes), a cache line which is also enough for any SIMD
+// (up to AVX-512) load.
+constexpr size_t SimdAlignment = 64;
+
+/* Allocator of Alignment aligned memory, so std::vector data can be loaded with aligned SIMD loads. */
+template <typename T, size_t Alignment = SimdAlignment> class AlignedAllocator {
+  public:
+    using value_type = T;
+    template <typename U> struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+    void deallocate(T *p, size_t) { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+    template <typename U> bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+};
+
+template <typename T> using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+} // namespace back_trader
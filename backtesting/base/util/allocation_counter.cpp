@@ -0,0 +1,47 @@
+#include "allocation_counter.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace back_trader {
+#ifdef COUNT_ALLOCATIONS
+static thread_local size_t thread_allocations = 0;
+static std::atomic<size_t> total_allocations{0};
+
+static void count_allocation() {
+    ++thread_allocations;
+    total_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t thread_allocation_count() { return thread_allocations; }
+size_t total_allocation_count() { return total_allocations.load(std::memory_order_relaxed); }
+#else
+size_t thread_allocation_count() { return 0; }
+size_t total_allocation_count() { return 0; }
+#endif
+} // namespace back_trader
+
+#ifdef COUNT_ALLOCATIONS
+// Array and nothrow forms of the standard library call these.
+void *operator new(std::size_t size) {
+    back_trader::count_allocation();
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    back_trader::count_allocation();
+    const size_t align = static_cast<size_t>(alignment);
+    // aligned_alloc requires non zero size multiple of the alignment
+    if (void *ptr = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+#endif
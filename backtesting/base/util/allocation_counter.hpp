@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+
+namespace back_trader {
+/*
+ Heap allocation counting for checking that the hot loops don't allocate. Counting is opt in, when built with
+ COUNT_ALLOCATIONS (cmake -DCOUNT_ALLOCATIONS=ON) global operator new is replaced by a counting one
+ (allocation_counter.cpp), otherwise counts are always zero.
+*/
+#ifdef COUNT_ALLOCATIONS
+constexpr bool AllocationCountingEnabled = true;
+#else
+constexpr bool AllocationCountingEnabled = false;
+#endif
+
+// Number of heap allocations made by the calling thread.
+size_t thread_allocation_count();
+
+// Number of heap allocations made by all the threads.
+size_t total_allocation_count();
+} // namespace back_trader
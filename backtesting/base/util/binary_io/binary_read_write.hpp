@@ -1,45 +1,182 @@
 #pragma once
+#include "../../price_history/history_subset.hpp"
 #include "../quick_log.hpp"
 #include "common_util/time_util.hpp"
+#include "compressed_history_format.hpp"
+#include "history_file_format.hpp"
+#include <algorithm>
 #include <common_util.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
 #include <vector>
 using namespace common_util;
 namespace back_trader {
 
+/* Checks that the header matches the records of type T and the file is big enough for what header describe. */
+template <typename T> bool check_history_file_header(const HistoryFileHeader &header, size_t file_size) {
+    if (header.version < HistoryFileMinVersion || header.version > HistoryFileVersion) {
+        logError(string_format("Unsupported history file version ", header.version, " expected ", HistoryFileMinVersion,
+                               " to ", HistoryFileVersion));
+        return false;
+    }
+    if (header.record_type != static_cast<uint32_t>(HistoryRecordTraits<T>::type) || header.record_size != sizeof(T)) {
+        logError(string_format("History file records are not ", HistoryRecordTraits<T>::name, " (record type ",
+                               header.record_type, ", record size ", header.record_size, ")"));
+        return false;
+    }
+    if (header.index_offset + header.index_count * sizeof(HistoryIndexEntry) > file_size ||
+        header.records_offset + header.record_count * sizeof(T) > file_size) {
+        logError("History file is truncated");
+        return false;
+    }
+    return true;
+}
+
+/* Same as check_history_file_header for compressed history file. */
+template <typename T>
+bool check_compressed_history_file_header(const CompressedHistoryFileHeader &header, size_t file_size) {
+    if (header.version != CompressedHistoryFileVersion) {
+        logError(string_format("Unsupported compressed history file version ", header.version, " expected ",
+                               CompressedHistoryFileVersion));
+        return false;
+    }
+    if (header.record_type != static_cast<uint32_t>(HistoryRecordTraits<T>::type) || header.record_size != sizeof(T)) {
+        logError(string_format("Compressed history file records are not ", HistoryRecordTraits<T>::name,
+                               " (record type ", header.record_type, ", record size ", header.record_size, ")"));
+        return false;
+    }
+    if (header.blocks_offset + header.block_count * sizeof(CompressedHistoryBlock) > file_size) {
+        logError("Compressed history file is truncated");
+        return false;
+    }
+    const char *file_begin = reinterpret_cast<const char *>(&header);
+    const CompressedHistoryBlock *blocks =
+        reinterpret_cast<const CompressedHistoryBlock *>(file_begin + header.blocks_offset);
+    for (size_t i = 0; i < header.block_count; ++i) {
+        if (blocks[i].offset + blocks[i].word_count * sizeof(uint64_t) > file_size) {
+            logError("Compressed history file is truncated");
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Decodes records within [start_time, end_time) (0 means unbounded) of memory mapped compressed history file into
+ history. Only the blocks which overlap the time range are decoded. Returns false if the file header doesn't match T. */
+template <typename T>
+bool decode_compressed_history_file_records(const char *file_begin,       // nowrap
+                                            const size_t file_size,       // nowrap
+                                            const std::time_t start_time, // nowrap
+                                            const std::time_t end_time,   // nowrap
+                                            std::vector<T> &history) {
+    const CompressedHistoryFileHeader *header = get_compressed_history_file_header(file_begin, file_size);
+    if (!check_compressed_history_file_header<T>(*header, file_size))
+        return false;
+    const CompressedHistory<T> compressed_history(file_begin, *header);
+    const size_t first_block = start_time > 0 ? compressed_history.find_block(start_time) : 0;
+    const size_t last_block =
+        end_time > 0 ? compressed_history.find_block(end_time) + 1 : compressed_history.block_count();
+    history.reserve(compressed_history.block_record_index(last_block) -
+                    compressed_history.block_record_index(first_block));
+    for (auto it = compressed_history.block_begin(first_block); it.block() < last_block; ++it) {
+        if (end_time > 0 && it->timestamp_sec >= end_time)
+            break;
+        if (it->timestamp_sec >= start_time)
+            history.push_back(*it);
+    }
+    return true;
+}
+
+/* Finds records within [start_time, end_time) (0 means unbounded) of memory mapped history file by binary search, with
+ the sparse index for files with header or over the raw records of older files, so records before start_time are never
+ touched. Returns false if the file header doesn't match T. */
+template <typename T>
+bool find_history_file_records(const std::string &file_name, // nowrap
+                               const char *file_begin,       // nowrap
+                               const size_t file_size,       // nowrap
+                               const std::time_t start_time, // nowrap
+                               const std::time_t end_time,   // nowrap
+                               const T *&records_begin,      // nowrap
+                               const T *&records_end) {
+    const HistoryFileHeader *header = get_history_file_header(file_begin, file_size);
+    if (header != nullptr) {
+        if (!check_history_file_header<T>(*header, file_size))
+            return false;
+        const T *records = reinterpret_cast<const T *>(file_begin + header->records_offset);
+        const size_t record_count = header->record_count;
+        const HistoryIndexEntry *index = reinterpret_cast<const HistoryIndexEntry *>(file_begin + header->index_offset);
+        const size_t index_count = header->index_count;
+        const size_t first =
+            start_time > 0 ? find_history_record(records, record_count, index, index_count, start_time) : 0;
+        const size_t last =
+            end_time > 0 ? find_history_record(records, record_count, index, index_count, end_time) : record_count;
+        records_begin = records + first;
+        records_end = records + std::max(first, last);
+        return true;
+    }
+    logInfo(string_format(file_name, " doesn't have history header, reading it as raw ", HistoryRecordTraits<T>::name,
+                          " records"));
+    const T *records = reinterpret_cast<const T *>(file_begin);
+    const auto subset = history_subset(HistoryView<T>(records, records + file_size / sizeof(T)), start_time, end_time);
+    records_begin = subset.first;
+    records_end = subset.second;
+    return true;
+}
+
+/* Returns indexes (from begin) of invalid records in [begin, end), see find_invalid_ohlc_ticks. */
+template <typename T> using HistoryValidator = std::function<std::vector<size_t>(const T *begin, const T *end)>;
+
+/* Reads records within [start_time, end_time] of binary history file. Range is found by binary search and history is
+ reserved exactly. If validate is given, whole range is validated in one bulk pass first, every invalid record is
+ reported and left out of the history. */
 template <typename T>
 std::vector<T> read_history_from_binary_file(const std::string &file_name, // nowrap
                                              const std::time_t start_time, // nowrap
                                              const std::time_t end_time,   // nowrap
-                                             std::function<bool(const T &)> validate) {
+                                             const HistoryValidator<T> &validate) {
+    constexpr size_t MaxReportedInvalidRecords = 10;
     const std::time_t latency_start_time = std::time(nullptr);
     logInfo(string_format("Reading history from binary file ", file_name));
-    common_util::RMemoryMapped<T> read_file(file_name);
-    const T *begin = read_file.begin();
-    const T *end = read_file.end();
+    common_util::RMemoryMapped<char> read_file(file_name);
     std::vector<T> price_history;
-    if (!validate) {
+    const T *begin = nullptr;
+    const T *end = nullptr;
+    // Compressed records are decoded first and validated in place
+    const bool compressed = get_compressed_history_file_header(read_file.begin(), read_file.size()) != nullptr;
+    std::vector<T> decoded_history;
+    if (compressed) {
+        if (!decode_compressed_history_file_records(read_file.begin(), read_file.size(), start_time,
+                                                    end_time > 0 ? end_time + 1 : 0, decoded_history))
+            return price_history;
+        begin = decoded_history.data();
+        end = decoded_history.data() + decoded_history.size();
+    } else if (!find_history_file_records(file_name, read_file.begin(), read_file.size(), start_time,
+                                          end_time > 0 ? end_time + 1 : 0, begin, end)) {
+        return price_history;
+    }
+    const std::vector<size_t> invalid_indexes = validate ? validate(begin, end) : std::vector<size_t>();
+    if (invalid_indexes.empty() && compressed) {
+        price_history = std::move(decoded_history);
+    } else if (invalid_indexes.empty()) {
         price_history.assign(begin, end);
     } else {
-        // run time validataion and push value to price history
-        uint64_t valid_count = 0;
-        while (begin != end) {
-            T history = *begin;
-            if (start_time > 0 && history.timestamp_sec < start_time) {
-                ++begin;
-                continue;
-            }
-
-            if (end_time > 0 && history.timestamp_sec > end_time)
-                break;
-            if (validate(history)) {
-                price_history.push_back(history);
-                ++valid_count;
-            } else {
-                logError(string_format("Reading history from binary file, Invalid at line number ", valid_count));
-                break;
-            }
-            ++begin;
+        std::string reported_indexes;
+        for (size_t i = 0; i < std::min(invalid_indexes.size(), MaxReportedInvalidRecords); ++i)
+            reported_indexes += string_format(i ? ", " : "", invalid_indexes[i]);
+        logError(string_format("Reading history from binary file, ", invalid_indexes.size(),
+                               " invalid records skipped (from the first selected record): ", reported_indexes,
+                               invalid_indexes.size() > MaxReportedInvalidRecords ? ", ..." : ""));
+        // Copy valid runs between invalid records
+        price_history.reserve((end - begin) - invalid_indexes.size());
+        const T *valid_begin = begin;
+        for (const size_t invalid_index : invalid_indexes) {
+            price_history.insert(price_history.end(), valid_begin, begin + invalid_index);
+            valid_begin = begin + invalid_index + 1;
         }
+        price_history.insert(price_history.end(), valid_begin, end);
     }
 
     const std::time_t latency_end_time = std::time(nullptr);
@@ -48,19 +185,264 @@ std::vector<T> read_history_from_binary_file(const std::string &file_name, // no
     return price_history;
 }
 
+/* Returns zero copy view of records within [start_time, end_time) of binary history file. View owns the memory mapped
+ file so records are read straight from the mapping (no copy, pages are loaded as simulation walks over them) and the
+ file stays mapped as long as any view of it is alive. Records are not validated here. */
+template <typename T>
+HistoryView<T> read_history_view_from_binary_file(const std::string &file_name, // nowrap
+                                                  const std::time_t start_time, // nowrap
+                                                  const std::time_t end_time) {
+    logInfo(string_format("Mapping history from binary file ", file_name));
+    auto read_file = std::make_shared<const common_util::RMemoryMapped<char>>(file_name);
+    if (get_compressed_history_file_header(read_file->begin(), read_file->size()) != nullptr) {
+        // Compressed records can't be used in place, history is decoded once and the view owns it
+        auto history = std::make_shared<std::vector<T>>();
+        if (!decode_compressed_history_file_records(read_file->begin(), read_file->size(), start_time, end_time,
+                                                    *history))
+            return HistoryView<T>();
+        const T *begin = history->data();
+        const T *end = history->data() + history->size();
+        return HistoryView<T>(begin, end, std::move(history));
+    }
+    const T *begin = nullptr;
+    const T *end = nullptr;
+    if (!find_history_file_records(file_name, read_file->begin(), read_file->size(), start_time, end_time, begin, end))
+        return HistoryView<T>();
+    return HistoryView<T>(begin, end, std::move(read_file));
+}
+
+/* Reads HistoryFileHeader of binary history file without mapping its records, returns false if the file can't be read
+ or doesn't have (uncompressed history) header. */
+inline bool read_history_file_header(const std::string &file_name, HistoryFileHeader &header) {
+    std::ifstream file(file_name, std::ios::binary);
+    return file.read(reinterpret_cast<char *>(&header), sizeof(header)) &&
+           get_history_file_header(reinterpret_cast<const char *>(&header), sizeof(header)) != nullptr;
+}
+
+/* Returns HistoryFileHeader::last_source_timestamp_sec of binary history file, 0 if it's unknown (file without header
+ or written by version 1). */
+inline int64_t read_last_source_timestamp_from_binary_file(const std::string &file_name) {
+    HistoryFileHeader header;
+    if (!read_history_file_header(file_name, header))
+        return 0;
+    return get_last_source_timestamp_sec(header);
+}
+
+/* Reads HistoryFileHeader::last_record of binary history file, returns false if file doesn't have it (file without
+ header, written by version 1 or 2 or without records). */
+template <typename T> bool read_last_record_from_binary_file(const std::string &file_name, T &record) {
+    HistoryFileHeader header;
+    return read_history_file_header(file_name, header) && get_last_record(header, record);
+}
+
+/* Reads number of records and timestamp of the last record (0 without records) of binary history file with header,
+ compressed or raw, without mapping its records. Returns false if the file can't be read. */
 template <typename T>
-bool write_history_to_binary_file(const std::vector<T> &history, const std::string &output_price_history_binary_file) {
+bool read_history_file_extent(const std::string &file_name, uint64_t &record_count, int64_t &last_timestamp_sec) {
+    std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    const size_t file_size = static_cast<size_t>(file.tellg());
+    alignas(8) char header[std::max(sizeof(HistoryFileHeader), sizeof(CompressedHistoryFileHeader))];
+    const size_t header_size = std::min(file_size, sizeof(header));
+    if (!file.seekg(0).read(header, header_size))
+        return false;
+    const HistoryFileHeader *history_header = get_history_file_header(header, header_size);
+    if (history_header != nullptr) {
+        record_count = history_header->record_count;
+        last_timestamp_sec = history_header->last_timestamp_sec;
+        return true;
+    }
+    const CompressedHistoryFileHeader *compressed_header = get_compressed_history_file_header(header, header_size);
+    if (compressed_header != nullptr) {
+        record_count = compressed_header->record_count;
+        last_timestamp_sec = compressed_header->last_timestamp_sec;
+        return true;
+    }
+    record_count = file_size / sizeof(T);
+    last_timestamp_sec = 0;
+    if (record_count == 0)
+        return true;
+    T last_record;
+    if (!file.seekg((record_count - 1) * sizeof(T)).read(reinterpret_cast<char *>(&last_record), sizeof(T)))
+        return false;
+    last_timestamp_sec = last_record.timestamp_sec;
+    return true;
+}
+
+/* Write history with HistoryFileHeader and sparse (daily) time index in front of the records, see
+ history_file_format.hpp for the layout. last_source_timestamp_sec is the last price record OHLC history was built from
+ (0 if it's unknown). */
+template <typename T>
+bool write_history_to_binary_file(const std::vector<T> &history, const std::string &output_price_history_binary_file,
+                                  int64_t last_source_timestamp_sec = 0) {
     const std::time_t latency_start_time = std::time(nullptr);
     logInfo(string_format("Number of records ", history.size(), " to file ", output_price_history_binary_file));
+    const std::vector<HistoryIndexEntry> index = build_history_index(history, HistoryIndexIntervalSec);
+    const HistoryFileHeader header = make_history_file_header(history, index.size(), last_source_timestamp_sec);
     // Memory map the file to output binary file
-    size_t file_size = sizeof(T) * history.size();
-    common_util::WMemoryMapped<T> write_file(output_price_history_binary_file, file_size);
-    T *begin = write_file.begin();
-    std::copy(history.begin(), history.end(), begin);
+    size_t file_size = header.records_offset + sizeof(T) * history.size();
+    common_util::WMemoryMapped<char> write_file(output_price_history_binary_file, file_size);
+    char *begin = write_file.begin();
+    std::memset(begin, 0, header.records_offset);
+    std::memcpy(begin, &header, sizeof(header));
+    std::memcpy(begin + header.index_offset, index.data(), index.size() * sizeof(HistoryIndexEntry));
+    std::copy(history.begin(), history.end(), reinterpret_cast<T *>(begin + header.records_offset));
     write_file.flush();
     const std::time_t latency_end_time = std::time(nullptr);
 
     logInfo(string_format("Finished in ", duration_to_string(latency_end_time - latency_start_time)));
     return true;
 }
-} // namespace back_trader
\ No newline at end of file
+/* Replaces records of binary history file from first_record_index on with tail_history (so the last record can be
+ updated and new ones appended) and sets last_source_timestamp_sec and last_record of the header. Only the new records,
+ index and header are written in place, header goes last. Until the header is written it still describes the old
+ records and index entries, except the old last record which may already be overwritten when first_record_index is its
+ index. So update interrupted before the header is written is repeated from HistoryFileHeader::last_record (see
+ read_last_record_from_binary_file), not from the last record in the file. File without (current version) header or
+ without free index entries left is rewritten as a whole into a temporary file which then replaces it. */
+template <typename T>
+bool update_history_tail_in_binary_file(const std::vector<T> &tail_history, size_t first_record_index,
+                                        const std::string &output_price_history_binary_file,
+                                        int64_t last_source_timestamp_sec) {
+    const std::time_t latency_start_time = std::time(nullptr);
+    logInfo(string_format("Updating ", tail_history.size(), " records from record ", first_record_index, " of file ",
+                          output_price_history_binary_file));
+    std::fstream file(output_price_history_binary_file, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file) {
+        logError(string_format("Cannot open ", output_price_history_binary_file));
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    const size_t file_size = static_cast<size_t>(file.tellg());
+    char file_begin[sizeof(HistoryFileHeader)] = {};
+    file.seekg(0);
+    file.read(file_begin, std::min(file_size, sizeof(file_begin)));
+    if (get_compressed_history_file_header(file_begin, file_size) != nullptr) {
+        logError("Compressed history file can't be updated in place");
+        return false;
+    }
+    const HistoryFileHeader *file_header = get_history_file_header(file_begin, file_size);
+    std::vector<HistoryIndexEntry> index;
+    uint64_t index_capacity = 0;
+    if (file_header != nullptr) {
+        if (!check_history_file_header<T>(*file_header, file_size))
+            return false;
+        if (first_record_index > file_header->record_count) {
+            logError(string_format("History file has only ", file_header->record_count, " records"));
+            return false;
+        }
+        index.resize(file_header->index_count);
+        file.seekg(file_header->index_offset);
+        file.read(reinterpret_cast<char *>(index.data()), index.size() * sizeof(HistoryIndexEntry));
+        // Entries of the replaced records are built again
+        while (!index.empty() && index.back().record_index >= first_record_index)
+            index.pop_back();
+        append_history_index(index, tail_history.data(), tail_history.size(), first_record_index,
+                             file_header->index_interval_sec);
+        index_capacity = (file_header->records_offset - file_header->index_offset) / sizeof(HistoryIndexEntry);
+    }
+
+    // Current header doesn't fit in front of the index of version 1 file
+    if (file_header == nullptr || file_header->version != HistoryFileVersion || index.size() > index_capacity) {
+        file.close();
+        logInfo("History file has no current header or no free index entries left, rewriting the whole file");
+        std::vector<T> history =
+            read_history_from_binary_file<T>(output_price_history_binary_file, 0, 0, HistoryValidator<T>());
+        if (first_record_index > history.size()) {
+            logError(string_format("History file has only ", history.size(), " records"));
+            return false;
+        }
+        history.resize(first_record_index);
+        history.insert(history.end(), tail_history.begin(), tail_history.end());
+        const std::string temporary_file_name = output_price_history_binary_file + ".tmp";
+        if (!write_history_to_binary_file(history, temporary_file_name, last_source_timestamp_sec))
+            return false;
+        std::error_code error_code;
+        std::filesystem::rename(temporary_file_name, output_price_history_binary_file, error_code);
+        if (error_code) {
+            logError(string_format("Cannot replace ", output_price_history_binary_file, ": ", error_code.message()));
+            return false;
+        }
+        return true;
+    }
+
+    HistoryFileHeader header = *file_header;
+    header.record_count = first_record_index + tail_history.size();
+    if (first_record_index == 0)
+        header.first_timestamp_sec = tail_history.empty() ? 0 : tail_history.front().timestamp_sec;
+    if (!tail_history.empty())
+        header.last_timestamp_sec = tail_history.back().timestamp_sec;
+    header.index_count = index.size();
+    header.last_source_timestamp_sec = last_source_timestamp_sec;
+    if (!tail_history.empty()) {
+        set_last_record(header, tail_history.back());
+    } else if (first_record_index > 0) {
+        // Records after first_record_index are dropped, record before them is the last one
+        T last_record;
+        file.seekg(header.records_offset + (first_record_index - 1) * sizeof(T));
+        file.read(reinterpret_cast<char *>(&last_record), sizeof(T));
+        set_last_record(header, last_record);
+    }
+    file.seekp(header.records_offset + first_record_index * sizeof(T));
+    file.write(reinterpret_cast<const char *>(tail_history.data()), tail_history.size() * sizeof(T));
+    file.seekp(header.index_offset);
+    file.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(HistoryIndexEntry));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.flush();
+    if (!file) {
+        logError(string_format("Failed to update ", output_price_history_binary_file));
+        return false;
+    }
+    const std::time_t latency_end_time = std::time(nullptr);
+    logInfo(string_format("Finished in ", duration_to_string(latency_end_time - latency_start_time)));
+    return true;
+}
+
+/* Write history as compressed history file, CompressedHistoryBlockSize records per block, see
+ compressed_history_format.hpp for the layout and encoding. */
+template <typename T>
+bool write_compressed_history_to_binary_file(const std::vector<T> &history,
+                                             const std::string &output_price_history_binary_file) {
+    const std::time_t latency_start_time = std::time(nullptr);
+    logInfo(string_format("Number of records ", history.size(), " to compressed file ",
+                          output_price_history_binary_file));
+    CompressedHistoryFileHeader header{};
+    std::memcpy(header.magic, CompressedHistoryFileMagic, sizeof(header.magic));
+    header.version = CompressedHistoryFileVersion;
+    header.record_type = static_cast<uint32_t>(HistoryRecordTraits<T>::type);
+    header.record_size = sizeof(T);
+    header.record_count = history.size();
+    header.first_timestamp_sec = history.empty() ? 0 : history.front().timestamp_sec;
+    header.last_timestamp_sec = history.empty() ? 0 : history.back().timestamp_sec;
+    header.block_size = CompressedHistoryBlockSize;
+    header.block_count = (history.size() + CompressedHistoryBlockSize - 1) / CompressedHistoryBlockSize;
+    header.blocks_offset = align_history_file_offset(sizeof(CompressedHistoryFileHeader));
+
+    std::vector<CompressedHistoryBlock> blocks(header.block_count);
+    std::vector<std::vector<uint64_t>> block_words(header.block_count);
+    uint64_t offset = header.blocks_offset + header.block_count * sizeof(CompressedHistoryBlock);
+    for (size_t i = 0; i < header.block_count; ++i) {
+        const size_t first = i * CompressedHistoryBlockSize;
+        const size_t last = std::min<size_t>(first + CompressedHistoryBlockSize, history.size());
+        block_words[i] = encode_compressed_history_block(history.data() + first, history.data() + last);
+        blocks[i] = {history[first].timestamp_sec, first, offset, block_words[i].size()};
+        offset += block_words[i].size() * sizeof(uint64_t);
+    }
+    // Memory map the file to output binary file
+    common_util::WMemoryMapped<char> write_file(output_price_history_binary_file, offset);
+    char *begin = write_file.begin();
+    std::memset(begin, 0, header.blocks_offset);
+    std::memcpy(begin, &header, sizeof(header));
+    std::memcpy(begin + header.blocks_offset, blocks.data(), blocks.size() * sizeof(CompressedHistoryBlock));
+    for (size_t i = 0; i < header.block_count; ++i)
+        std::memcpy(begin + blocks[i].offset, block_words[i].data(), block_words[i].size() * sizeof(uint64_t));
+    write_file.flush();
+    const std::time_t latency_end_time = std::time(nullptr);
+
+    logInfo(string_format("Compressed ", sizeof(T) * history.size(), " bytes to ", offset, " bytes in ",
+                          duration_to_string(latency_end_time - latency_start_time)));
+    return true;
+}
+} // namespace back_trader
@@ -0,0 +1,90 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace back_trader {
+// Mask of the lowest bit_count (1 to 64) bits.
+constexpr uint64_t low_bits_mask(int bit_count) {
+    return bit_count >= 64 ? ~uint64_t(0) : (uint64_t(1) << bit_count) - 1;
+}
+
+/* Appends values of any bit width (most significant bit first) into 64 bit words. */
+class BitWriter {
+  public:
+    // Writes the lowest bit_count (0 to 64) bits of value.
+    void write(uint64_t value, int bit_count) {
+        if (bit_count == 0)
+            return;
+        value &= low_bits_mask(bit_count);
+        const int free_bits = 64 - _used_bits;
+        if (bit_count <= free_bits) {
+            _current |= value << (free_bits - bit_count);
+            _used_bits += bit_count;
+            if (_used_bits == 64)
+                flush_current();
+            return;
+        }
+        const int rest_bits = bit_count - free_bits;
+        _current |= value >> rest_bits;
+        flush_current();
+        _current = value << (64 - rest_bits);
+        _used_bits = rest_bits;
+    }
+
+    // Returns written words, last word is padded with zeros.
+    std::vector<uint64_t> finish() {
+        if (_used_bits > 0)
+            flush_current();
+        return std::move(_words);
+    }
+
+  private:
+    std::vector<uint64_t> _words;
+    uint64_t _current = 0;
+    int _used_bits = 0;
+
+    void flush_current() {
+        _words.push_back(_current);
+        _current = 0;
+        _used_bits = 0;
+    }
+};
+
+/* Reads values written by BitWriter in the same order and bit widths. */
+class BitReader {
+  public:
+    BitReader(const uint64_t *words, size_t word_count) : _words(words), _word_count(word_count) {}
+
+    uint64_t read(int bit_count) {
+        if (bit_count == 0)
+            return 0;
+        assert(_index < _word_count);
+        const int available_bits = 64 - _used_bits;
+        const uint64_t word = _words[_index] << _used_bits;
+        if (bit_count <= available_bits) {
+            _used_bits += bit_count;
+            if (_used_bits == 64) {
+                ++_index;
+                _used_bits = 0;
+            }
+            return word >> (64 - bit_count);
+        }
+        const int rest_bits = bit_count - available_bits;
+        const uint64_t high = word >> (64 - available_bits);
+        ++_index;
+        assert(_index < _word_count);
+        _used_bits = rest_bits;
+        return (high << rest_bits) | (_words[_index] >> (64 - rest_bits));
+    }
+
+    bool read_bit() { return read(1) != 0; }
+
+  private:
+    const uint64_t *_words;
+    size_t _word_count;
+    size_t _index = 0;
+    int _used_bits = 0;
+};
+} // namespace back_trader
@@ -0,0 +1,324 @@
+#pragma once
+#include "bit_stream.hpp"
+#include "history_file_format.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace back_trader {
+/*
+ Layout of compressed binary history file:
+    [CompressedHistoryFileHeader][CompressedHistoryBlock x block_count][block words]...
+ Records are split into blocks of block_size records and every block is encoded on its own (first record of a block is
+ stored as it is), so any block can be decoded without the ones before it. In a block
+    - timestamps are delta of delta encoded (regular intervals take a single bit per record).
+    - every float field is XORed with the same field of the previous record and only the meaningful bits of the XOR
+      are stored (Gorilla, https://www.vldb.org/pvldb/vol8/p1816-teller.pdf), unchanged values take a single bit.
+*/
+
+// Differs from HistoryFileMagic in the last byte, so reader can tell raw and compressed history files apart.
+constexpr char CompressedHistoryFileMagic[8] = {'B', 'T', 'H', 'I', 'S', 'T', 'R', 'Z'};
+constexpr uint32_t CompressedHistoryFileVersion = 1;
+constexpr uint64_t CompressedHistoryBlockSize = 4096;
+
+struct CompressedHistoryFileHeader {
+    char magic[8];
+    uint32_t version;
+    // HistoryRecordType of records.
+    uint32_t record_type;
+    // sizeof of a single (decoded) record.
+    uint64_t record_size;
+    uint64_t record_count;
+    // Timestamp of first and last record (0 if there isn't any record).
+    int64_t first_timestamp_sec;
+    int64_t last_timestamp_sec;
+    // Number of records in every block except the last one.
+    uint64_t block_size;
+    uint64_t block_count;
+    uint64_t blocks_offset;
+};
+
+// Block index entry, blocks are sorted by first_timestamp_sec.
+struct CompressedHistoryBlock {
+    int64_t first_timestamp_sec;
+    // Index of the first record of the block.
+    uint64_t record_index;
+    // Offset of the encoded words from the start of the file and number of 64 bit words.
+    uint64_t offset;
+    uint64_t word_count;
+};
+
+// Float fields of record which are XOR encoded, timestamp is encoded separately.
+template <typename T> struct CompressedRecordFields;
+template <> struct CompressedRecordFields<PriceRecord> {
+    static constexpr size_t count = 2;
+    static void get(const PriceRecord &record, float *fields) {
+        fields[0] = record.price;
+        fields[1] = record.volume;
+    }
+    static PriceRecord make(int64_t timestamp_sec, const float *fields) {
+        return {timestamp_sec, fields[0], fields[1]};
+    }
+};
+template <> struct CompressedRecordFields<OhlcTick> {
+    static constexpr size_t count = 5;
+    static void get(const OhlcTick &ohlc_tick, float *fields) {
+        fields[0] = ohlc_tick.open;
+        fields[1] = ohlc_tick.high;
+        fields[2] = ohlc_tick.low;
+        fields[3] = ohlc_tick.close;
+        fields[4] = ohlc_tick.volume;
+    }
+    static OhlcTick make(int64_t timestamp_sec, const float *fields) {
+        return {timestamp_sec, fields[0], fields[1], fields[2], fields[3], fields[4]};
+    }
+};
+template <> struct CompressedRecordFields<FearAndGreedRecord> {
+    static constexpr size_t count = 1;
+    static void get(const FearAndGreedRecord &record, float *fields) { fields[0] = record.signal; }
+    static FearAndGreedRecord make(int64_t timestamp_sec, const float *fields) { return {timestamp_sec, fields[0]}; }
+};
+
+/* Delta of delta of timestamps, zigzag encoded and stored with a prefix of the bucket it fits in
+ ('0' for 0, '10' 7 bits, '110' 12 bits, '1110' 20 bits, '1111' 64 bits). */
+class TimestampCodec {
+  public:
+    void encode(int64_t timestamp_sec, BitWriter &writer) {
+        const int64_t delta = static_cast<int64_t>(static_cast<uint64_t>(timestamp_sec) - _prev_timestamp_sec);
+        const uint64_t delta_of_delta = static_cast<uint64_t>(delta) - static_cast<uint64_t>(_prev_delta);
+        const uint64_t zigzag =
+            (delta_of_delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta_of_delta) >> 63);
+        if (zigzag == 0) {
+            writer.write(0b0, 1);
+        } else if (zigzag < (uint64_t(1) << 7)) {
+            writer.write(0b10, 2);
+            writer.write(zigzag, 7);
+        } else if (zigzag < (uint64_t(1) << 12)) {
+            writer.write(0b110, 3);
+            writer.write(zigzag, 12);
+        } else if (zigzag < (uint64_t(1) << 20)) {
+            writer.write(0b1110, 4);
+            writer.write(zigzag, 20);
+        } else {
+            writer.write(0b1111, 4);
+            writer.write(zigzag, 64);
+        }
+        _prev_timestamp_sec = timestamp_sec;
+        _prev_delta = delta;
+    }
+
+    int64_t decode(BitReader &reader) {
+        int prefix = 0;
+        while (prefix < 4 && reader.read_bit())
+            ++prefix;
+        constexpr int BucketBits[5] = {0, 7, 12, 20, 64};
+        const uint64_t zigzag = reader.read(BucketBits[prefix]);
+        const uint64_t delta_of_delta = (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+        _prev_delta = static_cast<int64_t>(static_cast<uint64_t>(_prev_delta) + delta_of_delta);
+        _prev_timestamp_sec = static_cast<int64_t>(static_cast<uint64_t>(_prev_timestamp_sec) + _prev_delta);
+        return _prev_timestamp_sec;
+    }
+
+  private:
+    int64_t _prev_timestamp_sec = 0;
+    int64_t _prev_delta = 0;
+};
+
+/* XOR of float with the previous value, '0' if it's the same, '10' and the meaningful bits if they fit into the
+ previous leading/trailing zero window, otherwise '11', 5 bits of leading zeros, 5 bits of (length - 1) and the bits. */
+class FloatCodec {
+  public:
+    void encode(float value, BitWriter &writer) {
+        const uint32_t bits = to_bits(value);
+        const uint32_t xor_bits = bits ^ _prev_bits;
+        _prev_bits = bits;
+        if (xor_bits == 0) {
+            writer.write(0b0, 1);
+            return;
+        }
+        const int leading_zeros = __builtin_clz(xor_bits);
+        const int trailing_zeros = __builtin_ctz(xor_bits);
+        if (_meaningful_bits > 0 && leading_zeros >= _leading_zeros &&
+            trailing_zeros >= 32 - _leading_zeros - _meaningful_bits) {
+            writer.write(0b10, 2);
+            writer.write(xor_bits >> (32 - _leading_zeros - _meaningful_bits), _meaningful_bits);
+            return;
+        }
+        _leading_zeros = leading_zeros;
+        _meaningful_bits = 32 - leading_zeros - trailing_zeros;
+        writer.write(0b11, 2);
+        writer.write(_leading_zeros, 5);
+        writer.write(_meaningful_bits - 1, 5);
+        writer.write(xor_bits >> trailing_zeros, _meaningful_bits);
+    }
+
+    float decode(BitReader &reader) {
+        if (reader.read_bit()) {
+            if (reader.read_bit()) {
+                _leading_zeros = static_cast<int>(reader.read(5));
+                _meaningful_bits = static_cast<int>(reader.read(5)) + 1;
+            }
+            const int trailing_zeros = 32 - _leading_zeros - _meaningful_bits;
+            _prev_bits ^= static_cast<uint32_t>(reader.read(_meaningful_bits)) << trailing_zeros;
+        }
+        return from_bits(_prev_bits);
+    }
+
+  private:
+    uint32_t _prev_bits = 0;
+    int _leading_zeros = 0;
+    // 0 until the first window is written.
+    int _meaningful_bits = 0;
+
+    static uint32_t to_bits(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+    static float from_bits(uint32_t bits) {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+// Encodes records [begin, end) as a single independently decodable block.
+template <typename T> std::vector<uint64_t> encode_compressed_history_block(const T *begin, const T *end) {
+    using Fields = CompressedRecordFields<T>;
+    BitWriter writer;
+    TimestampCodec timestamp_encoder;
+    FloatCodec field_encoders[Fields::count];
+    float fields[Fields::count];
+    for (const T *record = begin; record != end; ++record) {
+        timestamp_encoder.encode(record->timestamp_sec, writer);
+        Fields::get(*record, fields);
+        for (size_t i = 0; i < Fields::count; ++i)
+            field_encoders[i].encode(fields[i], writer);
+    }
+    return writer.finish();
+}
+
+// Decodes record_count records of a block into records.
+template <typename T>
+void decode_compressed_history_block(const uint64_t *words, size_t word_count, size_t record_count, T *records) {
+    using Fields = CompressedRecordFields<T>;
+    BitReader reader(words, word_count);
+    TimestampCodec timestamp_decoder;
+    FloatCodec field_decoders[Fields::count];
+    float fields[Fields::count];
+    for (size_t r = 0; r < record_count; ++r) {
+        const int64_t timestamp_sec = timestamp_decoder.decode(reader);
+        for (size_t i = 0; i < Fields::count; ++i)
+            fields[i] = field_decoders[i].decode(reader);
+        records[r] = Fields::make(timestamp_sec, fields);
+    }
+}
+
+// Returns header of memory mapped compressed history file or nullptr if it isn't one.
+inline const CompressedHistoryFileHeader *get_compressed_history_file_header(const char *file_begin,
+                                                                              size_t file_size) {
+    if (file_size < sizeof(CompressedHistoryFileHeader) ||
+        std::memcmp(file_begin, CompressedHistoryFileMagic, sizeof(CompressedHistoryFileMagic)) != 0)
+        return nullptr;
+    return reinterpret_cast<const CompressedHistoryFileHeader *>(file_begin);
+}
+
+/*
+ Read only history of memory mapped compressed history file (header has to be checked before). Records are decoded
+ block by block as the iterator walks over them, only one block of records is in memory per iterator. Block is decoded
+ on the first access to its records, so stepping onto a block (ex:- the one after the last block of a time range) or
+ creating end iterator doesn't decode anything.
+*/
+template <typename T> class CompressedHistory {
+  public:
+    CompressedHistory(const char *file_begin, const CompressedHistoryFileHeader &header)
+        : _file_begin(file_begin), _header(header),
+          _blocks(reinterpret_cast<const CompressedHistoryBlock *>(file_begin + header.blocks_offset)) {}
+
+    size_t size() const { return _header.record_count; }
+    size_t block_count() const { return _header.block_count; }
+    size_t block_record_index(size_t block) const {
+        return block < block_count() ? _blocks[block].record_index : size();
+    }
+
+    /* Returns the first block which can contain a record with timestamp >= timestamp_sec. It's the block before the
+     first one starting at (or after) timestamp_sec, as records of the same timestamp can span two blocks. */
+    size_t find_block(int64_t timestamp_sec) const {
+        const CompressedHistoryBlock *next_block =
+            std::lower_bound(_blocks, _blocks + block_count(), timestamp_sec,
+                             [](const CompressedHistoryBlock &block, int64_t timestamp_sec) {
+                                 return block.first_timestamp_sec < timestamp_sec;
+                             });
+        return next_block == _blocks ? 0 : static_cast<size_t>(next_block - _blocks) - 1;
+    }
+
+    void decode_block(size_t block, std::vector<T> &records) const {
+        const CompressedHistoryBlock &history_block = _blocks[block];
+        records.resize(block_record_index(block + 1) - history_block.record_index);
+        decode_compressed_history_block(reinterpret_cast<const uint64_t *>(_file_begin + history_block.offset),
+                                        history_block.word_count, records.size(), records.data());
+    }
+
+    class const_iterator {
+      public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator(const CompressedHistory *history, size_t block) : _history(history) { move_to_block(block); }
+
+        const T &operator*() const { return get_records()[_position]; }
+        const T *operator->() const { return &get_records()[_position]; }
+        const_iterator &operator++() {
+            if (++_position == _record_count)
+                move_to_block(_block + 1);
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const {
+            return _block == other._block && _position == other._position;
+        }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+        // Block of the current record (block_count() at the end).
+        size_t block() const { return _block; }
+
+      private:
+        const CompressedHistory *_history;
+        size_t _block = 0;
+        size_t _position = 0;
+        // Number of records of the block, known from the block index without decoding it.
+        size_t _record_count = 0;
+        // Records of the block once they are accessed (decoded is false until then).
+        mutable std::vector<T> _records;
+        mutable bool _decoded = false;
+
+        void move_to_block(size_t block) {
+            _block = block;
+            _position = 0;
+            _record_count = _history->block_record_index(block + 1) - _history->block_record_index(block);
+            _decoded = false;
+        }
+        const std::vector<T> &get_records() const {
+            if (!_decoded) {
+                _history->decode_block(_block, _records);
+                _decoded = true;
+            }
+            return _records;
+        }
+    };
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, block_count()); }
+    // Iterator at the first record of block.
+    const_iterator block_begin(size_t block) const { return const_iterator(this, block); }
+
+  private:
+    const char *_file_begin;
+    const CompressedHistoryFileHeader &_header;
+    const CompressedHistoryBlock *_blocks;
+};
+} // namespace back_trader
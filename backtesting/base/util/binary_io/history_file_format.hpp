@@ -0,0 +1,182 @@
+#pragma once
+#include "../../common_interface/common.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace back_trader {
+/*
+ Layout of binary history (.mov) file:
+    [HistoryFileHeader][HistoryIndexEntry x index_count][free index entries][T x record_count]
+ Offsets are from the start of the file and multiple of 8 bytes, so index and records can be used in place from the
+ memory mapped file. Files written before the header was added are raw T[] and still readable (without any check).
+*/
+
+// "BTHISTRY" can't be mistaken for the first timestamp of a raw (headerless) history file.
+constexpr char HistoryFileMagic[8] = {'B', 'T', 'H', 'I', 'S', 'T', 'R', 'Y'};
+// Bump when layout of the header or index changes.
+constexpr uint32_t HistoryFileVersion = 3;
+// Version 1 files (without last_source_timestamp_sec) and version 2 files (without last_record) are still readable.
+constexpr uint32_t HistoryFileMinVersion = 1;
+// Sparse time index has one entry per day of history.
+constexpr int64_t HistoryIndexIntervalSec = 24 * 60 * 60;
+/* Space for index entries is reserved in multiples of this (about 2.8 years of days), so history can be appended in
+ place until the reserved entries run out. */
+constexpr uint64_t HistoryIndexCapacityStep = 1024;
+// Space for the copy of the last record in the header, every record type fits in it.
+constexpr size_t HistoryFileMaxRecordSize = 32;
+
+enum class HistoryRecordType : uint32_t {
+    PRICE_RECORD = 1,
+    OHLC_TICK = 2,
+    FEAR_AND_GREED_RECORD = 3,
+};
+
+// Type of record stored in history file, only these types can be written into binary history file.
+template <typename T> struct HistoryRecordTraits;
+template <> struct HistoryRecordTraits<PriceRecord> {
+    static constexpr HistoryRecordType type = HistoryRecordType::PRICE_RECORD;
+    static constexpr const char *name = "PriceRecord";
+};
+template <> struct HistoryRecordTraits<OhlcTick> {
+    static constexpr HistoryRecordType type = HistoryRecordType::OHLC_TICK;
+    static constexpr const char *name = "OhlcTick";
+};
+template <> struct HistoryRecordTraits<FearAndGreedRecord> {
+    static constexpr HistoryRecordType type = HistoryRecordType::FEAR_AND_GREED_RECORD;
+    static constexpr const char *name = "FearAndGreedRecord";
+};
+
+struct HistoryFileHeader {
+    char magic[8];
+    uint32_t version;
+    // HistoryRecordType of records.
+    uint32_t record_type;
+    // sizeof of a single record.
+    uint64_t record_size;
+    uint64_t record_count;
+    // Timestamp of first and last record (0 if there isn't any record).
+    int64_t first_timestamp_sec;
+    int64_t last_timestamp_sec;
+    // Time interval covered by single index entry.
+    int64_t index_interval_sec;
+    uint64_t index_count;
+    uint64_t index_offset;
+    // Space between the index and records is reserved for more index entries.
+    uint64_t records_offset;
+    /* Timestamp of the last price record OHLC ticks were built from, price records up to it are already in the
+     history (0 if it's unknown, ex:- history not built from price records). Since version 2. */
+    int64_t last_source_timestamp_sec;
+    /* Copy of the last record as it was built up to last_source_timestamp_sec. Last record is updated in place when
+     history is appended, before the header, so it's read from here to continue from a consistent state. Since
+     version 3. */
+    char last_record[HistoryFileMaxRecordSize];
+};
+
+// Last price record timestamp of header, 0 for version 1 header (field overlaps its index).
+inline int64_t get_last_source_timestamp_sec(const HistoryFileHeader &header) {
+    return header.version >= 2 ? header.last_source_timestamp_sec : 0;
+}
+
+/* Copies last record of header into record, returns false for header without it (version 1 and 2, field overlaps
+ their index) or without any record. */
+template <typename T> bool get_last_record(const HistoryFileHeader &header, T &record) {
+    if (header.version < 3 || header.record_count == 0)
+        return false;
+    std::memcpy(&record, header.last_record, sizeof(T));
+    return true;
+}
+
+template <typename T> void set_last_record(HistoryFileHeader &header, const T &record) {
+    static_assert(sizeof(T) <= HistoryFileMaxRecordSize, "record doesn't fit in HistoryFileHeader::last_record");
+    std::memset(header.last_record, 0, sizeof(header.last_record));
+    std::memcpy(header.last_record, &record, sizeof(T));
+}
+
+// Sparse time index entry, record_index is the first record of the interval starting at timestamp_sec.
+struct HistoryIndexEntry {
+    int64_t timestamp_sec;
+    uint64_t record_index;
+};
+
+constexpr uint64_t align_history_file_offset(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+/* Adds index entries of records (record_index of records[0] is first_record_index) to index of the records before them.
+ History is expected to be sorted by timestamp. */
+template <typename T>
+void append_history_index(std::vector<HistoryIndexEntry> &index, const T *records, size_t record_count,
+                          uint64_t first_record_index, int64_t index_interval_sec) {
+    for (size_t i = 0; i < record_count; ++i) {
+        const int64_t timestamp_sec = records[i].timestamp_sec;
+        const int64_t interval_timestamp_sec = timestamp_sec - (timestamp_sec % index_interval_sec);
+        if (index.empty() || index.back().timestamp_sec < interval_timestamp_sec)
+            index.push_back({interval_timestamp_sec, first_record_index + i});
+    }
+}
+
+/* Returns one index entry for every index_interval_sec interval which have at least one record. History is expected
+ to be sorted by timestamp. */
+template <typename T>
+std::vector<HistoryIndexEntry> build_history_index(const std::vector<T> &history, int64_t index_interval_sec) {
+    std::vector<HistoryIndexEntry> index;
+    append_history_index(index, history.data(), history.size(), 0, index_interval_sec);
+    return index;
+}
+
+template <typename T>
+HistoryFileHeader make_history_file_header(const std::vector<T> &history, size_t index_count,
+                                           int64_t last_source_timestamp_sec = 0) {
+    HistoryFileHeader header{};
+    std::memcpy(header.magic, HistoryFileMagic, sizeof(header.magic));
+    header.version = HistoryFileVersion;
+    header.record_type = static_cast<uint32_t>(HistoryRecordTraits<T>::type);
+    header.record_size = sizeof(T);
+    header.record_count = history.size();
+    header.first_timestamp_sec = history.empty() ? 0 : history.front().timestamp_sec;
+    header.last_timestamp_sec = history.empty() ? 0 : history.back().timestamp_sec;
+    header.index_interval_sec = HistoryIndexIntervalSec;
+    header.index_count = index_count;
+    header.last_source_timestamp_sec = last_source_timestamp_sec;
+    if (!history.empty())
+        set_last_record(header, history.back());
+    header.index_offset = align_history_file_offset(sizeof(HistoryFileHeader));
+    // at least one free entry
+    const uint64_t index_capacity = (index_count / HistoryIndexCapacityStep + 1) * HistoryIndexCapacityStep;
+    header.records_offset =
+        align_history_file_offset(header.index_offset + index_capacity * sizeof(HistoryIndexEntry));
+    return header;
+}
+
+// Returns header of memory mapped history file or nullptr if it's a raw (headerless) history file.
+inline const HistoryFileHeader *get_history_file_header(const char *file_begin, size_t file_size) {
+    if (file_size < sizeof(HistoryFileHeader) ||
+        std::memcmp(file_begin, HistoryFileMagic, sizeof(HistoryFileMagic)) != 0)
+        return nullptr;
+    return reinterpret_cast<const HistoryFileHeader *>(file_begin);
+}
+
+/* Returns index of the first record with timestamp >= timestamp_sec. Index entry of the interval timestamp_sec falls
+ into is found by binary search, so only records of that interval are searched. */
+template <typename T>
+size_t find_history_record(const T *records, size_t record_count, const HistoryIndexEntry *index, size_t index_count,
+                           int64_t timestamp_sec) {
+    const HistoryIndexEntry *index_end = index + index_count;
+    // First entry after timestamp_sec, interval of the entry before it contains timestamp_sec
+    const HistoryIndexEntry *next_entry =
+        std::upper_bound(index, index_end, timestamp_sec,
+                         [](int64_t timestamp_sec, const HistoryIndexEntry &entry) {
+                             return timestamp_sec < entry.timestamp_sec;
+                         });
+    if (next_entry == index)
+        return 0;
+    const size_t first = (next_entry - 1)->record_index;
+    const size_t last = next_entry == index_end ? record_count : next_entry->record_index;
+    const T *record = std::lower_bound(records + first, records + last, timestamp_sec,
+                                       [](const T &record, int64_t timestamp_sec) {
+                                           return record.timestamp_sec < timestamp_sec;
+                                       });
+    return record - records;
+}
+} // namespace back_trader
@@ -1,19 +1,37 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #define MAX_PRICE_DEVIATION_PER_MIN 0.05
 #define INTERVAL_RATE_SEC 300
 #define TOP_N_GAPS 50
 #define LAST_N_OUTLIERS 20
-#define COMPRESS_IN_BYTE true
+#define COMPRESS_IN_BYTE false
 #define EVALUATE_COMBINATION false
+// 0 evaluates every combination on all periods, otherwise only 1/SUCCESSIVE_HALVING survive each round
+#define SUCCESSIVE_HALVING 0
+// number of best combinations printed (and kept by successive halving)
+#define TOP_N_RESULTS 30
+// 0 evaluates the default grid of combinations, otherwise number of configs evaluated by parameter search
+#define SEARCH_BUDGET 0
+#define SEARCH_BATCH_SIZE 32
+#define SEARCH_ELITE_RATIO 0.2
+#define SEARCH_SEED 1
+#define INGESTION_THREADS 1
+// 0 is one thread per hardware thread
+#define SIMULATION_THREADS 0
+#define APPEND_OHLC_HISTORY false
+// OHLC range index is built on every run unless it is persisted next to the history file
+#define PERSIST_RANGE_INDEX false
 // available data full range
 #define START_TIME "2011-09-14"
 #define END_TIME "2024-06-13"
 #define NOT_FOUND "NOT_FOUND"
-constexpr std::array<std::pair<std::string_view, std::string_view>, 24> args{
+constexpr std::array<std::pair<std::string_view, std::string_view>, 36> args{
     {{"input_price_history_csv_file", "input_price_history_csv_file"},
      {"input_price_history_binary_file", "input_price_history_binary_file"},
      {"output_price_history_binary_file", "output_price_history_binary_file"},
@@ -33,11 +51,23 @@ constexpr std::array<std::pair<std::string_view, std::string_view>, 24> args{
      {"output_simulator_log_file", "output_simulator_log_file"},
      {"simulator", "simulator"},
      {"evaluation_period_months", "evaluation_period_months"},
+     {"evaluation_window", "evaluation_window"},
+     {"evaluation_step", "evaluation_step"},
      {"start_base_balance", "start_base_balance"},
      {"start_quote_balance", "start_quote_balance"},
      {"market_liquidity", "market_liquidity"},
      {"max_volume_ratio", "max_volume_ratio"},
-     {"evaluate_combination", "evaluate_combination"}}};
+     {"evaluate_combination", "evaluate_combination"},
+     {"successive_halving", "successive_halving"},
+     {"search_budget", "search_budget"},
+     {"search_batch_size", "search_batch_size"},
+     {"search_seed", "search_seed"},
+     {"shard", "shard"},
+     {"output_results_file", "output_results_file"},
+     {"merge_results_files", "merge_results_files"},
+     {"threads", "threads"},
+     {"persist_range_index", "persist_range_index"},
+     {"append_ohlc_history", "append_ohlc_history"}}};
 
 constexpr std::string_view get_value(std::string_view key) {
     for (const auto &val : args) {
@@ -49,3 +79,15 @@ constexpr std::string_view get_value(std::string_view key) {
 }
 
 constexpr bool arg_valid(std::string_view key) { return get_value(key) != NOT_FOUND; }
+
+// Split comma separated list argument value (ex:- --interval_rate_sec=300,1800,3600) into its values.
+inline std::vector<std::string> split_arg_list(std::string_view value, char delimiter = ',') {
+    std::vector<std::string> values;
+    size_t start = 0;
+    while (start <= value.size() && !value.empty()) {
+        const size_t found = std::min(value.find(delimiter, start), value.size());
+        values.emplace_back(value.substr(start, found - start));
+        start = found + 1;
+    }
+    return values;
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace back_trader {
+
+/* Returns pointer to the first delimiter in [begin, end) or end if there isn't any.
+ With AVX2 (SSE2) 32 (16) bytes are compared at once and the position is taken from the bit mask of matched bytes,
+ what is left at the tail (or on other architectures) is compared byte by byte. */
+inline const char *find_delimiter(const char *begin, const char *end, char delimiter) {
+#if defined(__AVX2__)
+    const __m256i pattern_32 = _mm256_set1_epi8(delimiter);
+    while (end - begin >= 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, pattern_32)));
+        if (mask != 0)
+            return begin + __builtin_ctz(mask);
+        begin += 32;
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i pattern_16 = _mm_set1_epi8(delimiter);
+    while (end - begin >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern_16)));
+        if (mask != 0)
+            return begin + __builtin_ctz(mask);
+        begin += 16;
+    }
+#endif
+    while (begin != end && *begin != delimiter)
+        ++begin;
+    return begin;
+}
+
+/* Parse comma separated numeric fields of a single csv row (without the new line) into fields in the given order.
+ Values are converted in place with std::from_chars so there is no copy of the field. Returns false if any field is
+ missing, malformed or if there is anything left after the last field (other than '\r'). */
+template <typename... T> bool parse_csv_row(std::string_view row, T &...fields) {
+    const char *pos = row.data();
+    const char *const end = row.data() + row.size();
+    bool first_field = true;
+    const auto parse_field = [&](auto &field) {
+        if (!first_field) {
+            if (pos == end || *pos != ',')
+                return false;
+            ++pos;
+        }
+        first_field = false;
+        const std::from_chars_result result = std::from_chars(pos, end, field);
+        pos = result.ptr;
+        return result.ec == std::errc();
+    };
+    return (parse_field(fields) && ...) && (pos == end || *pos == '\r');
+}
+
+// Walks over the rows of a (memory mapped) csv view without copying them.
+class CsvRowReader {
+  public:
+    explicit CsvRowReader(std::string_view input) : _pos(input.data()), _end(input.data() + input.size()) {}
+
+    /* Sets row to the next non empty row (without new line). Returns false when the whole input is consumed.*/
+    bool next_row(std::string_view &row) {
+        while (_pos < _end) {
+            const char *row_end = find_delimiter(_pos, _end, '\n');
+            row = std::string_view(_pos, row_end - _pos);
+            _pos = row_end == _end ? _end : row_end + 1;
+            ++_row_number;
+            if (!row.empty() && row != "\r")
+                return true;
+        }
+        return false;
+    }
+
+    // Number of the row (starting with 1) last returned by next_row.
+    size_t row_number() const { return _row_number; }
+
+  private:
+    const char *_pos;
+    const char *_end;
+    size_t _row_number = 0;
+};
+
+/* Returns estimated number of rows in input based on the average length of the first sample_rows rows. It's used to
+ reserve the output history up front so it doesn't reallocate while parsing. */
+inline size_t estimate_csv_row_count(std::string_view input, size_t sample_rows = 1024) {
+    const char *const begin = input.data();
+    const char *const end = input.data() + input.size();
+    const char *pos = begin;
+    size_t rows = 0;
+    while (pos < end && rows < sample_rows) {
+        pos = find_delimiter(pos, end, '\n');
+        if (pos != end)
+            ++pos;
+        ++rows;
+    }
+    if (rows == 0)
+        return 0;
+    const size_t sampled_bytes = static_cast<size_t>(pos - begin);
+    // Rounded up so a row or two more doesn't trigger reallocation of the whole history.
+    return (input.size() * rows + sampled_bytes - 1) / sampled_bytes + 1;
+}
+
+/* Splits input into at most chunk_count chunks of about the same size. Every chunk (except the last one) ends right
+ after a new line so no row is split between two chunks and each chunk can be parsed on its own. */
+inline std::vector<std::string_view> split_csv_into_chunks(std::string_view input, size_t chunk_count) {
+    std::vector<std::string_view> chunks;
+    if (input.empty())
+        return chunks;
+    chunk_count = std::max<size_t>(1, chunk_count);
+    const size_t chunk_size = (input.size() + chunk_count - 1) / chunk_count;
+    const char *const end = input.data() + input.size();
+    const char *chunk_begin = input.data();
+    chunks.reserve(chunk_count);
+    while (chunk_begin < end) {
+        const size_t remaining = static_cast<size_t>(end - chunk_begin);
+        const char *chunk_end =
+            remaining <= chunk_size ? end : find_delimiter(chunk_begin + chunk_size - 1, end, '\n');
+        if (chunk_end != end)
+            ++chunk_end;
+        chunks.emplace_back(chunk_begin, static_cast<size_t>(chunk_end - chunk_begin));
+        chunk_begin = chunk_end;
+    }
+    return chunks;
+}
+
+} // namespace back_trader
@@ -0,0 +1,126 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace back_trader {
+/*
+ Fixed number of worker threads with work stealing. Unlike std::async per task the number of threads doesn't grow with
+ the number of tasks, so big sweeps don't oversubscribe the cores.
+ Every worker has its own deque, submitted tasks are dealt to the deques round robin. A worker takes tasks from the
+ front of its own deque and when it is empty steals from the back of the others. Submitting tasks sorted by expected
+ cost (longest first) makes every worker start on the longest tasks while the short ones at the back are left to even
+ out the tail of the batch.
+ Destructor waits for all submitted tasks to finish.
+*/
+class ThreadPool {
+  public:
+    // thread_count 0 means one thread per hardware thread.
+    explicit ThreadPool(size_t thread_count) {
+        if (thread_count == 0)
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        _queues.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i)
+            _queues.emplace_back(std::make_unique<WorkerQueue>());
+        _workers.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i)
+            _workers.emplace_back([this, i]() { run_worker(i); });
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(_sleep_mutex);
+            _stopping = true;
+        }
+        _task_available.notify_all();
+        for (std::thread &worker : _workers)
+            worker.join();
+    }
+
+    size_t size() const { return _workers.size(); }
+
+    // Queue task, returned future gets its result (or exception).
+    template <typename Task> std::future<std::invoke_result_t<Task>> submit(Task task) {
+        using Result = std::invoke_result_t<Task>;
+        // std::function has to be copyable, packaged_task isn't
+        auto packaged_task = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+        std::future<Result> result = packaged_task->get_future();
+        WorkerQueue &queue = *_queues[_next_queue++ % _queues.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.emplace_back([packaged_task]() { (*packaged_task)(); });
+            ++_pending_tasks;
+        }
+        // Taking the sleep mutex makes sure a worker checking _pending_tasks doesn't miss the notification
+        { std::lock_guard<std::mutex> lock(_sleep_mutex); }
+        _task_available.notify_one();
+        return result;
+    }
+
+  private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> _workers;
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+    std::atomic<size_t> _next_queue{0};
+    // Tasks in all the queues (not yet taken by a worker).
+    std::atomic<size_t> _pending_tasks{0};
+    std::mutex _sleep_mutex;
+    std::condition_variable _task_available;
+    bool _stopping = false;
+
+    bool pop_task(size_t worker_index, std::function<void()> &task) {
+        WorkerQueue &queue = *_queues[worker_index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        --_pending_tasks;
+        return true;
+    }
+
+    bool steal_task(size_t worker_index, std::function<void()> &task) {
+        for (size_t offset = 1; offset < _queues.size(); ++offset) {
+            WorkerQueue &queue = *_queues[(worker_index + offset) % _queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+                continue;
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            --_pending_tasks;
+            return true;
+        }
+        return false;
+    }
+
+    void run_worker(size_t worker_index) {
+        while (true) {
+            std::function<void()> task;
+            if (pop_task(worker_index, task) || steal_task(worker_index, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(_sleep_mutex);
+            _task_available.wait(lock, [this]() { return _stopping || _pending_tasks > 0; });
+            if (_stopping && _pending_tasks == 0)
+                return;
+        }
+    }
+};
+} // namespace back_trader
@@ -0,0 +1,189 @@
+#include "evaluation_result_file.hpp"
+#include <algorithm>
+#include <base_header.hpp>
+#include <cassert>
+#include <charconv>
+#include <common_util.hpp>
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+
+namespace back_trader {
+static constexpr char ResultsColumns[] =
+    "index,name,score,avg_gain,avg_base_gain,avg_total_executed_orders,avg_total_fee";
+
+// 9 significant digits are enough to read back the same float.
+static void write_float(std::ostream &os, float value) {
+    char buffer[32];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    os.write(buffer, length);
+}
+
+uint64_t get_sweep_fingerprint(const SweepInputs &inputs) {
+    // Inputs are written as text (floats with all their digits), so the hash doesn't depend on their memory layout
+    std::ostringstream text;
+    const auto write_fee_config = [&](const FeeConfig &fee_config) {
+        write_float(text, fee_config.relative_fee);
+        text << ',';
+        write_float(text, fee_config.fixed_fee);
+        text << ',';
+        write_float(text, fee_config.minimum_fee);
+        text << ',';
+    };
+    const AccountConfig &account_config = inputs.account_config;
+    text << std::filesystem::path(inputs.history_file_name).filename().string() << ',' << inputs.history_record_count
+         << ',' << inputs.history_last_timestamp_sec << ',' << inputs.start_timestamp_sec << ','
+         << inputs.end_timestamp_sec << ',' << inputs.evaluation_window.count << ','
+         << static_cast<int>(inputs.evaluation_window.unit) << ',' << inputs.evaluation_step.count << ','
+         << static_cast<int>(inputs.evaluation_step.unit) << ',' << inputs.strategy_name << ',';
+    for (const float value : {account_config.start_base_balance, account_config.start_quote_balance,
+                              account_config.base_unit, account_config.quote_unit, account_config.market_liquidity,
+                              account_config.max_volume_ratio}) {
+        write_float(text, value);
+        text << ',';
+    }
+    write_fee_config(account_config.market_order_fee_config);
+    write_fee_config(account_config.stop_order_fee_config);
+    write_fee_config(account_config.limit_order_fee_config);
+
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : text.str()) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool write_evaluation_results_file(const std::string &file_name,                                  // nowrap
+                                   const SweepShard &shard,                                        // nowrap
+                                   size_t sweep_size,                                              // nowrap
+                                   uint64_t sweep_fingerprint,                                     // nowrap
+                                   const std::vector<SimulatorEvaluationResult> &shard_results) {
+    const size_t first_index = shard.begin(sweep_size);
+    assert(shard.end(sweep_size) - first_index == shard_results.size());
+    std::ofstream results_stream(file_name);
+    if (!results_stream) {
+        logError(string_format("Can not open results file ", file_name));
+        return false;
+    }
+    char fingerprint[17];
+    std::snprintf(fingerprint, sizeof(fingerprint), "%016" PRIx64, sweep_fingerprint);
+    results_stream << "# shard " << shard.shard_index << '/' << shard.shard_count << " of " << sweep_size
+                   << " simulators, inputs " << fingerprint << '\n'
+                   << ResultsColumns << '\n';
+    for (size_t i = 0; i < shard_results.size(); ++i) {
+        const SimulatorEvaluationResult &result = shard_results[i];
+        results_stream << first_index + i << ',' << result.name << ',';
+        write_float(results_stream, result.score);
+        results_stream << ',';
+        write_float(results_stream, result.avg_gain);
+        results_stream << ',';
+        write_float(results_stream, result.avg_base_gain);
+        results_stream << ',';
+        write_float(results_stream, result.avg_total_executed_orders);
+        results_stream << ',';
+        write_float(results_stream, result.avg_total_fee);
+        results_stream << '\n';
+    }
+    return static_cast<bool>(results_stream);
+}
+
+// Parses "index,name,score,..." row, the name is everything up to the comma after the index.
+static bool parse_results_row(std::string_view row, size_t &index, SimulatorEvaluationResult &result) {
+    const char *const end = row.data() + row.size();
+    const auto [index_end, error] = std::from_chars(row.data(), end, index);
+    if (error != std::errc() || index_end == end || *index_end != ',')
+        return false;
+    const char *const name_begin = index_end + 1;
+    const char *const name_end = std::find(name_begin, end, ',');
+    if (name_end == end)
+        return false;
+    result.name.assign(name_begin, name_end);
+    return parse_csv_row(std::string_view(name_end + 1, end - name_end - 1), result.score, result.avg_gain,
+                         result.avg_base_gain, result.avg_total_executed_orders, result.avg_total_fee);
+}
+
+bool read_evaluation_results_files(const std::vector<std::string> &file_names, // nowrap
+                                   std::vector<SimulatorEvaluationResult> &sweep_results) {
+    if (file_names.empty()) {
+        logError("No results files to read");
+        return false;
+    }
+    size_t sweep_size = 0;
+    size_t shard_count = 0;
+    uint64_t sweep_fingerprint = 0;
+    // Shards and simulators (indexes of the sweep) already read
+    std::vector<bool> shard_read;
+    std::vector<bool> result_read;
+    for (const std::string &file_name : file_names) {
+        std::ifstream results_stream(file_name);
+        if (!results_stream) {
+            logError(string_format("Can not open results file ", file_name));
+            return false;
+        }
+        const std::string content((std::istreambuf_iterator<char>(results_stream)), std::istreambuf_iterator<char>());
+        CsvRowReader row_reader(content);
+        std::string_view row;
+        SweepShard shard{};
+        size_t file_sweep_size = 0;
+        uint64_t file_sweep_fingerprint = 0;
+        if (!row_reader.next_row(row) ||
+            std::sscanf(std::string(row).c_str(), "# shard %zu/%zu of %zu simulators, inputs %16" SCNx64,
+                        &shard.shard_index, &shard.shard_count, &file_sweep_size, &file_sweep_fingerprint) != 4 ||
+            shard.shard_index >= shard.shard_count || !row_reader.next_row(row) || row != ResultsColumns) {
+            logError(string_format(file_name, " is not a results file"));
+            return false;
+        }
+        if (shard_count == 0) {
+            shard_count = shard.shard_count;
+            sweep_size = file_sweep_size;
+            sweep_fingerprint = file_sweep_fingerprint;
+            shard_read.assign(shard_count, false);
+            result_read.assign(sweep_size, false);
+            sweep_results.assign(sweep_size, SimulatorEvaluationResult{});
+        } else if (shard.shard_count != shard_count || file_sweep_size != sweep_size) {
+            logError(string_format(file_name, " is a shard of another sweep"));
+            return false;
+        } else if (file_sweep_fingerprint != sweep_fingerprint) {
+            logError(string_format(file_name, " is a shard of sweep over other inputs (history, time range, windows, ",
+                                   "strategy or account)"));
+            return false;
+        }
+        if (shard_read[shard.shard_index]) {
+            logError(string_format(file_name, " is shard ", shard.shard_index, " which was already read"));
+            return false;
+        }
+        shard_read[shard.shard_index] = true;
+
+        size_t row_count = 0;
+        while (row_reader.next_row(row)) {
+            size_t index = 0;
+            SimulatorEvaluationResult result{};
+            if (!parse_results_row(row, index, result) || index < shard.begin(sweep_size) ||
+                index >= shard.end(sweep_size) || result_read[index]) {
+                logError(string_format("Invalid row ", row_reader.row_number(), " of ", file_name));
+                return false;
+            }
+            result_read[index] = true;
+            sweep_results[index] = std::move(result);
+            ++row_count;
+        }
+        if (row_count != shard.end(sweep_size) - shard.begin(sweep_size)) {
+            logError(string_format(file_name, " has ", row_count, " results, expected ",
+                                   shard.end(sweep_size) - shard.begin(sweep_size)));
+            return false;
+        }
+    }
+    const size_t missing_shards = std::count(shard_read.begin(), shard_read.end(), false);
+    if (missing_shards) {
+        logError(string_format("Missing ", missing_shards, " of ", shard_count, " shards"));
+        return false;
+    }
+    return true;
+}
+} // namespace back_trader
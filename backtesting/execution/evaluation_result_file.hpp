@@ -0,0 +1,57 @@
+#pragma once
+#include "simulation_types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace back_trader {
+// Part shard_index (from 0) of shard_count parts of a sweep, every part is a contiguous range of the sweep.
+struct SweepShard {
+    size_t shard_index;
+    size_t shard_count;
+
+    // [begin, end) indexes of the simulators of the shard in sweep of sweep_size simulators.
+    size_t begin(size_t sweep_size) const { return shard_index * sweep_size / shard_count; }
+    size_t end(size_t sweep_size) const { return (shard_index + 1) * sweep_size / shard_count; }
+};
+
+// Everything the results of a sweep depend on, except the simulators of the sweep (given by strategy_name).
+struct SweepInputs {
+    // History file (only its name, shards may run on machines with other paths) and its records.
+    std::string history_file_name;
+    uint64_t history_record_count;
+    int64_t history_last_timestamp_sec;
+    std::time_t start_timestamp_sec;
+    std::time_t end_timestamp_sec;
+    EvaluationTimeSpan evaluation_window;
+    EvaluationTimeSpan evaluation_step;
+    std::string strategy_name;
+    AccountConfig account_config;
+};
+
+// Hash (64 bit FNV-1a) of all the fields of inputs, same on every platform.
+uint64_t get_sweep_fingerprint(const SweepInputs &inputs);
+
+/*
+ * Writes results of the simulators of shard (in order of the sweep) of sweep of sweep_size simulators into CSV file.
+ * Only name, score and averages are written (not the periods), floats are written with all their digits so the merged
+ * ranking is the same as of the whole sweep in single process. sweep_fingerprint (see get_sweep_fingerprint) is written
+ * next to the shard, so shards of sweeps over other inputs are not merged.
+ * Returns false if the file can't be written.
+ */
+bool write_evaluation_results_file(const std::string &file_name,                                  // nowrap
+                                   const SweepShard &shard,                                        // nowrap
+                                   size_t sweep_size,                                              // nowrap
+                                   uint64_t sweep_fingerprint,                                     // nowrap
+                                   const std::vector<SimulatorEvaluationResult> &shard_results);
+
+/*
+ * Reads results files of all the shards of a sweep (in any order) into sweep_results in order of the sweep.
+ * Returns false (and logs the reason) if a file can't be read or the files are not exactly all shards of one sweep
+ * (same size and inputs fingerprint).
+ */
+bool read_evaluation_results_files(const std::vector<std::string> &file_names, // nowrap
+                                   std::vector<SimulatorEvaluationResult> &sweep_results);
+} // namespace back_trader
@@ -0,0 +1,112 @@
+#include "parameter_search.hpp"
+#include "simulation_executor.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <common_util.hpp>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <utility>
+
+namespace back_trader {
+// Share of the elite statistics in the next sampling distribution, the rest is kept from the previous one.
+static constexpr float DistributionSmoothing = 0.7f;
+// Minimum standard deviation relative to the parameter range, so the search never stops exploring completely.
+static constexpr float MinRelativeStddev = 0.01f;
+
+// Normal distribution of the sampled values of single parameter.
+struct ParameterDistribution {
+    float mean;
+    float stddev;
+};
+
+std::vector<SimulatorEvaluationResult> search_trade_simulator_parameters(
+    const AccountConfig &account_config,
+    const EvaluationPlan &evaluation_plan, // nowrap
+    const FearAndGreed *fear_and_greed_input,
+    const ParameterSearchSpace &parameter_search_space,   // nowrap
+    const ParameterSearchConfig &parameter_search_config, // nowrap
+    ThreadPool &thread_pool) {
+    const std::vector<ParameterRange> &parameter_ranges = parameter_search_space.parameter_ranges;
+    assert(parameter_search_config.batch_size > 0);
+    std::mt19937 random_generator(parameter_search_config.seed);
+
+    std::vector<ParameterDistribution> distributions;
+    distributions.reserve(parameter_ranges.size());
+    for (const ParameterRange &range : parameter_ranges)
+        distributions.push_back({(range.min_value + range.max_value) / 2, range.max_value - range.min_value});
+
+    // Parameter values and results of every evaluated config (same index)
+    std::vector<std::vector<float>> evaluated_parameters;
+    std::vector<SimulatorEvaluationResult> evaluation_results;
+    evaluation_results.reserve(parameter_search_config.max_evaluations);
+    for (size_t generation = 0; evaluation_results.size() < parameter_search_config.max_evaluations; ++generation) {
+        // First (uniform) generation explores the whole space with a quarter of the budget
+        const size_t generation_size =
+            generation == 0 ? std::max(parameter_search_config.batch_size, parameter_search_config.max_evaluations / 4)
+                            : parameter_search_config.batch_size;
+        const size_t batch_size =
+            std::min(generation_size, parameter_search_config.max_evaluations - evaluation_results.size());
+        // Sampling is serial (same seed same search), only evaluation is parallel
+        std::vector<std::unique_ptr<SimulatorDispatcher>> dispatchers;
+        dispatchers.reserve(batch_size);
+        for (size_t i = 0; i < batch_size; ++i) {
+            std::vector<float> parameters;
+            parameters.reserve(parameter_ranges.size());
+            for (size_t p = 0; p < parameter_ranges.size(); ++p) {
+                const ParameterRange &range = parameter_ranges[p];
+                float value;
+                if (generation == 0) {
+                    value = std::uniform_real_distribution<float>(range.min_value, range.max_value)(random_generator);
+                } else {
+                    value = std::normal_distribution<float>(distributions[p].mean,
+                                                            distributions[p].stddev)(random_generator);
+                }
+                parameters.push_back(std::clamp(value, range.min_value, range.max_value));
+            }
+            dispatchers.push_back(parameter_search_space.new_dispatcher(parameters));
+            evaluated_parameters.push_back(std::move(parameters));
+        }
+
+        std::vector<SimulatorEvaluationResult> generation_results = evaluate_combination_of_trade_simulators(
+            account_config, evaluation_plan, fear_and_greed_input, dispatchers, thread_pool);
+        std::move(generation_results.begin(), generation_results.end(), std::back_inserter(evaluation_results));
+
+        // Elite of all evaluated configs so far, best first
+        const size_t elite_count = std::clamp<size_t>(
+            std::lround(parameter_search_config.elite_ratio * evaluation_results.size()), 1, evaluation_results.size());
+        std::vector<size_t> ranking(evaluation_results.size());
+        std::iota(ranking.begin(), ranking.end(), 0);
+        std::partial_sort(ranking.begin(), ranking.begin() + elite_count, ranking.end(), [&](size_t lhs, size_t rhs) {
+            return evaluation_results[lhs].score > evaluation_results[rhs].score;
+        });
+        logInfo(string_format("Parameter search generation ", generation + 1, ": ", evaluation_results.size(),
+                              " evaluated, best ", evaluation_results[ranking.front()].name, ": ",
+                              evaluation_results[ranking.front()].score));
+
+        // Fit the next sampling distribution to the elite
+        for (size_t p = 0; p < parameter_ranges.size(); ++p) {
+            float mean = 0;
+            for (size_t e = 0; e < elite_count; ++e)
+                mean += evaluated_parameters[ranking[e]][p];
+            mean /= elite_count;
+            float variance = 0;
+            for (size_t e = 0; e < elite_count; ++e) {
+                const float deviation = evaluated_parameters[ranking[e]][p] - mean;
+                variance += deviation * deviation;
+            }
+            variance /= elite_count;
+            const float min_stddev =
+                MinRelativeStddev * (parameter_ranges[p].max_value - parameter_ranges[p].min_value);
+            distributions[p].mean =
+                DistributionSmoothing * mean + (1 - DistributionSmoothing) * distributions[p].mean;
+            distributions[p].stddev =
+                std::max(min_stddev, DistributionSmoothing * std::sqrt(variance) +
+                                         (1 - DistributionSmoothing) * distributions[p].stddev);
+        }
+    }
+    return evaluation_results;
+}
+} // namespace back_trader
@@ -0,0 +1,51 @@
+#pragma once
+#include "simulation_types.hpp"
+#include <base_header.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace back_trader {
+// Continuous range [min_value, max_value] of a strategy config parameter.
+struct ParameterRange {
+    std::string name;
+    float min_value;
+    float max_value;
+};
+
+// Parameters of a strategy config, new_dispatcher returns dispatcher of the config with given parameter values (one
+// value per parameter range in the same order).
+struct ParameterSearchSpace {
+    std::vector<ParameterRange> parameter_ranges;
+    std::function<std::unique_ptr<SimulatorDispatcher>(const std::vector<float> &)> new_dispatcher;
+};
+
+struct ParameterSearchConfig {
+    // Total number of evaluated configs (budget of the search).
+    size_t max_evaluations;
+    // Number of configs proposed (and evaluated in parallel) per generation.
+    size_t batch_size;
+    // Fraction of best configs (of all evaluated so far) the next generation is sampled around.
+    float elite_ratio;
+    // Seed of the sampling, same seed gives the same search.
+    uint32_t seed;
+};
+
+/*
+ * Searches parameter_search_space for configs with high score (cross entropy method). First generation (a quarter of
+ * the budget) is sampled uniformly over the parameter ranges, every next one from a normal distribution (per parameter)
+ * fitted to the elite configs, which narrows the search to the good regions. Generations are evaluated over all periods
+ * of evaluation_plan with evaluate_combination_of_trade_simulators (batched lanes on thread_pool).
+ * Returns results of all evaluated configs.
+ */
+std::vector<SimulatorEvaluationResult> search_trade_simulator_parameters(
+    const AccountConfig &account_config,
+    const EvaluationPlan &evaluation_plan, // nowrap
+    const FearAndGreed *fear_and_greed_input,
+    const ParameterSearchSpace &parameter_search_space,   // nowrap
+    const ParameterSearchConfig &parameter_search_config, // nowrap
+    ThreadPool &thread_pool);
+} // namespace back_trader
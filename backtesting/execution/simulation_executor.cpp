@@ -1,111 +1,173 @@
 #include "simulation_executor.hpp"
 #include "simulation_types.hpp"
+#include <algorithm>
 #include <cassert>
 #include <common_util.hpp>
 #include <cstddef>
 #include <cstdint>
 #include <future>
 #include <memory>
+#include <numeric>
+#include <utility>
 
 namespace back_trader {
-SimulationResult execute_trade_simulation(const AccountConfig &account_config,      // nowrap
-                                          OhlcHistory::const_iterator ohlc_begin,   // nowrap
-                                          OhlcHistory::const_iterator ohlc_end,     // nowrap
-                                          const FearAndGreed *fear_and_greed_input, // nowrap
-                                          bool fast_execute,                        // nowrap
-                                          TradeSimulator &trade_simulator,          // nowrap
-                                          SimulationLogger *logger) {
+OhlcHistoryView::const_iterator find_last_simulator_update(OhlcHistoryView::const_iterator ohlc_begin,
+                                                           OhlcHistoryView::const_iterator ohlc_end) {
+    for (auto ohlc_it = ohlc_end; ohlc_it != ohlc_begin;) {
+        if ((--ohlc_it)->volume != 0)
+            return ohlc_it;
+    }
+    return ohlc_end;
+}
+
+EvaluationPeriod get_evaluation_period(std::time_t start_timestamp_sec,            // nowrap
+                                       std::time_t end_timestamp_sec,              // nowrap
+                                       OhlcHistoryView::const_iterator ohlc_begin, // nowrap
+                                       OhlcHistoryView::const_iterator ohlc_end) {
+    assert(ohlc_begin != ohlc_end);
+    EvaluationPeriod evaluation_period;
+    evaluation_period.start_timestamp_sec = start_timestamp_sec;
+    evaluation_period.end_timestamp_sec = end_timestamp_sec;
+    evaluation_period.ohlc_begin = ohlc_begin;
+    evaluation_period.ohlc_end = ohlc_end;
+    evaluation_period.ohlc_last_update = find_last_simulator_update(ohlc_begin, ohlc_end);
+    evaluation_period.start_price = ohlc_begin->close;
+    // end iterator are 1 pass end
+    evaluation_period.end_price = (ohlc_end - 1)->close;
+    assert(evaluation_period.start_price > 0 && evaluation_period.end_price > 0);
+    // gain for buy and hold
+    evaluation_period.base_final_gain = evaluation_period.end_price / evaluation_period.start_price;
+    return evaluation_period;
+}
+
+SimulationResult get_simulation_result(const AccountConfig &account_config,       // nowrap
+                                       const EvaluationPeriod &evaluation_period, // nowrap
+                                       float end_base_balance,                    // nowrap
+                                       float end_quote_balance,                   // nowrap
+                                       float total_fee,                           // nowrap
+                                       int total_order) {
     SimulationResult simulation_result;
-    // No data to process
-    if (ohlc_begin == ohlc_end)
-        return {};
-
-    // Every simulator (strategy) would have it's own account to track the transaction
-    Account account;
-    account.init_account(account_config);
-    std::vector<Order> orders;
-    constexpr size_t DispatchedOrderReserve = 8;
-    orders.reserve(DispatchedOrderReserve);
-    int count_executed_orders = 0;
-    for (auto ohlc_it = ohlc_begin; ohlc_it != ohlc_end; ++ohlc_it) {
-        // TODO :- handle fear_and_greed_input here according to each ohlc tick
-        const OhlcTick &ohlc_tick = *ohlc_it;
+    simulation_result.start_base_balance = account_config.start_base_balance;
+    simulation_result.start_quote_balance = account_config.start_quote_balance;
+    simulation_result.end_base_balance = end_base_balance;
+    simulation_result.end_quote_balance = end_quote_balance;
+    simulation_result.start_price = evaluation_period.start_price;
+    simulation_result.end_price = evaluation_period.end_price;
+    simulation_result.start_value =
+        simulation_result.start_quote_balance + simulation_result.start_price * simulation_result.start_base_balance;
 
-        // Log current ohlc and account
-        if (logger) {
-            logger->log_account_state(ohlc_tick, account);
-        }
+    simulation_result.end_value =
+        simulation_result.end_quote_balance + simulation_result.end_price * simulation_result.end_base_balance;
 
-        /*
-         *  The trade simulator was updated on the previous OHLC tick OHLC_HISTORY[i-1] and emitted
-         *  "orders". There are no other active orders on the exchange.
-         *  Execute (or cancel) "orders" on the current OHLC tick OHLC_HISTORY[i].
-         */
-
-        for (const Order &order : orders) {
-            const bool executed = account.execute_order(account_config, order, ohlc_tick);
-            if (executed) {
-                ++count_executed_orders;
-                // Log only in case when order is executed
-                if (logger)
-                    logger->log_account_state(ohlc_tick, account, order);
+    simulation_result.total_order = total_order;
+    simulation_result.total_fee = total_fee;
+    // TODO :- calculate volatility for now keep it zero
+    simulation_result.base_volatility = 0.0f;
+    simulation_result.simulator_volatility = 0.0f;
+    return simulation_result;
+}
+
+SimulationResult execute_trade_simulation(const AccountConfig &account_config,       // nowrap
+                                          const EvaluationPeriod &evaluation_period, // nowrap
+                                          const FearAndGreed *fear_and_greed_input,  // nowrap
+                                          bool fast_execute,                         // nowrap
+                                          TradeSimulator &trade_simulator,           // nowrap
+                                          SimulationLogger *logger) {
+    return execute_trade_simulation<TradeSimulator>(account_config, evaluation_period, fear_and_greed_input,
+                                                    fast_execute, trade_simulator, logger);
+}
+
+std::vector<SimulationResult> execute_batch_trade_simulation(const AccountConfig &account_config,       // nowrap
+                                                             const EvaluationPeriod &evaluation_period, // nowrap
+                                                             const FearAndGreed *fear_and_greed_input,  // nowrap
+                                                             BatchTradeSimulator &batch_trade_simulator) {
+    const size_t lane_count = batch_trade_simulator.size();
+    std::vector<SimulationResult> simulation_results(lane_count);
+
+    // Result is taken at the last update of the simulators, ticks without volume after it only execute orders
+    const OhlcHistoryView::const_iterator ohlc_end = evaluation_period.ohlc_end;
+    const OhlcHistoryView::const_iterator last_update_it = evaluation_period.ohlc_last_update;
+    // No data to process
+    if (last_update_it == ohlc_end)
+        return simulation_results;
+
+    // Accounts of the lanes, orders are executed by the same account code as single simulator. Balances of the lanes
+    // (structure of arrays) are refreshed from the accounts for the batch simulator.
+    SimulationAccount start_account;
+    start_account.init_account(account_config);
+    std::vector<SimulationAccount> accounts(lane_count, start_account);
+    AlignedVector<float> base_balances(lane_count, get_base_balance(start_account));
+    AlignedVector<float> quote_balances(lane_count, get_quote_balance(start_account));
+    std::vector<int> count_executed_orders(lane_count, 0);
+    BatchOrders orders;
+    orders.resize(lane_count, batch_trade_simulator.max_orders_per_lane());
+    [[maybe_unused]] const size_t setup_allocation_count = thread_allocation_count();
+    for (auto ohlc_it = evaluation_period.ohlc_begin; ohlc_it != ohlc_end; ++ohlc_it) {
+        const OhlcTick &ohlc_tick = *ohlc_it;
+        for (size_t lane = 0; lane < lane_count; ++lane) {
+            if (orders.order_counts[lane] == 0)
+                continue;
+            SimulationAccount &account = accounts[lane];
+            for (const Order *order = orders.lane_begin(lane); order != orders.lane_end(lane); ++order) {
+                if (account.execute_order(account_config, *order, ohlc_tick))
+                    ++count_executed_orders[lane];
             }
+            base_balances[lane] = get_base_balance(account);
+            quote_balances[lane] = get_quote_balance(account);
         }
 
-        if (ohlc_tick.volume == 0) {
-            /*
-             * zero volume on ohlc tick is missing price history so we keep our order as what was generated for previous
-             * order In real world exchange api is down let's pause for a bit.
-             */
+        // zero volume on ohlc tick is missing price history, keep the orders of previous tick
+        if (ohlc_tick.volume == 0)
             continue;
-        }
 
-        // as we have already executed previous tick order let update for current ohlc tick
+        // Result is taken at the last update, orders emitted by it can't change the result
+        if (ohlc_it == last_update_it)
+            break;
         orders.clear();
-        trade_simulator.update(ohlc_tick, {}, account.base_balance, account.quote_balance, orders);
-        if (logger)
-            logger->log_simulator_state(trade_simulator.get_internal_state());
-
-        // TODO :- handle calculation of volatility according to fast_execute
-
-        simulation_result.start_base_balance = account_config.start_base_balance;
-        simulation_result.start_quote_balance = account_config.start_quote_balance;
-        simulation_result.end_base_balance = account.base_balance;
-        simulation_result.end_quote_balance = account.quote_balance;
-        simulation_result.start_price = ohlc_begin->close;
-        // end iterator are 1 pass end
-        simulation_result.end_price = (ohlc_end - 1)->close;
-        simulation_result.start_value = simulation_result.start_quote_balance +
-                                        simulation_result.start_price * simulation_result.start_base_balance;
-
-        simulation_result.end_value =
-            simulation_result.end_quote_balance + simulation_result.end_price * simulation_result.end_base_balance;
-
-        simulation_result.total_order = count_executed_orders;
-        simulation_result.total_fee = account.total_fee;
-        // TODO :- calculate volatility for now keep it zero
-        simulation_result.base_volatility = 0.0f;
-        simulation_result.simulator_volatility = 0.0f;
+        batch_trade_simulator.update(ohlc_tick, base_balances.data(), quote_balances.data(), orders);
+
+        // Ticks on which none of the lanes does anything are skipped (balances don't change without fill)
+        ohlc_it = skip_steady_ticks(batch_trade_simulator, ohlc_it + 1, last_update_it,
+                                    evaluation_period.ohlc_range_index) -
+                  1;
     }
-    return simulation_result;
+    assert(thread_allocation_count() == setup_allocation_count);
+
+    for (size_t lane = 0; lane < lane_count; ++lane) {
+        simulation_results[lane] = get_simulation_result(account_config, evaluation_period, base_balances[lane],
+                                                         quote_balances[lane], get_total_fee(accounts[lane]),
+                                                         count_executed_orders[lane]);
+    }
+    return simulation_results;
 }
 
-SimulatorEvaluationResult evaluate_trade_simulator(const AccountConfig &account_config,              // nowrap
-                                                   const SimEvaluationConfig &sim_evaluation_config, // nowrap
-                                                   const OhlcHistory &ohlc_histroy,                  // nowrap
-                                                   const FearAndGreed *fear_and_greed_input,         // nowrap
-                                                   const SimulatorDispatcher &simulator_dispatcher,  // nowrap
-                                                   SimulationLogger *logger) {
-    SimulatorEvaluationResult simulation_eval_result;
-    simulation_eval_result.account_config = account_config;
-    simulation_eval_result.sim_evaluation_config = sim_evaluation_config;
-    simulation_eval_result.name = simulator_dispatcher.get_names();
-    for (int month_offset = 0;; ++month_offset) {
-        const int64_t start_evalueation_timestamp_sec =
-            add_months(sim_evaluation_config.start_timestamp_sec, month_offset);
+std::time_t add_time_span(std::time_t timestamp_sec, const EvaluationTimeSpan &time_span, int32_t times) {
+    switch (time_span.unit) {
+    case EvaluationTimeSpan::Unit::DAY:
+        return timestamp_sec + int64_t(times) * time_span.count * SecondsPerDay;
+    case EvaluationTimeSpan::Unit::WEEK:
+        return timestamp_sec + int64_t(times) * time_span.count * 7 * SecondsPerDay;
+    case EvaluationTimeSpan::Unit::MONTH:
+        return add_months(timestamp_sec, times * time_span.count);
+    default:
+        assert(false);
+    }
+    return timestamp_sec;
+}
+
+EvaluationPlan get_evaluation_plan(const SimEvaluationConfig &sim_evaluation_config, // nowrap
+                                   const OhlcHistoryView &ohlc_history,              // nowrap
+                                   const OhlcRangeIndex *ohlc_range_index) {
+    assert(!ohlc_range_index || ohlc_range_index->covers(ohlc_history));
+    assert(sim_evaluation_config.evaluation_window.count == 0 || sim_evaluation_config.evaluation_step.count > 0);
+    EvaluationPlan evaluation_plan;
+    evaluation_plan.sim_evaluation_config = sim_evaluation_config;
+    for (int32_t step_offset = 0;; ++step_offset) {
+        const int64_t start_evalueation_timestamp_sec = add_time_span(
+            sim_evaluation_config.start_timestamp_sec, sim_evaluation_config.evaluation_step, step_offset);
         const int64_t end_evaluation_timestamp_sec =
-            sim_evaluation_config.evaluation_period_months > 0
-                ? add_months(start_evalueation_timestamp_sec, sim_evaluation_config.evaluation_period_months)
+            sim_evaluation_config.evaluation_window.count > 0
+                ? add_time_span(start_evalueation_timestamp_sec, sim_evaluation_config.evaluation_window)
                 : sim_evaluation_config.end_timestamp_sec;
         if (end_evaluation_timestamp_sec > sim_evaluation_config.end_timestamp_sec) {
             break;
@@ -113,32 +175,64 @@ SimulatorEvaluationResult evaluate_trade_simulator(const AccountConfig &account_
 
         // Get pair of iterator which denote start and end of time stamp
         auto ohlc_history_subset =
-            history_subset(ohlc_histroy, start_evalueation_timestamp_sec, end_evaluation_timestamp_sec);
+            history_subset(ohlc_history, start_evalueation_timestamp_sec, end_evaluation_timestamp_sec);
         // skip no data found
-        if (ohlc_history_subset.first == ohlc_history_subset.second)
-            continue;
-        std::unique_ptr<TradeSimulator> trade_simulator = simulator_dispatcher.new_simulator();
-        SimulationResult sim_result = execute_trade_simulation(account_config,             // nowrap
-                                                               ohlc_history_subset.first,  // nowrap
-                                                               ohlc_history_subset.second, // nowrap
-                                                               {}, false,                  // nowrap
-                                                               *trade_simulator,           // nowrap
-                                                               logger);
-        simulation_eval_result.periods.emplace_back();
-        SimulatorEvaluationResult::TimePeriod *time_period = &simulation_eval_result.periods.back();
-        time_period->start_timestamp_sec = start_evalueation_timestamp_sec;
-        time_period->end_timestamp_sec = end_evaluation_timestamp_sec;
-        time_period->result = sim_result;
-        assert(sim_result.start_value > 0);
-        time_period->final_gain = (sim_result.end_value / sim_result.start_value);
-        assert(sim_result.start_price > 0 && sim_result.end_price > 0);
-        // gain for buy and hold
-        time_period->base_final_gain = (sim_result.end_price / sim_result.start_price);
-        if (sim_evaluation_config.evaluation_period_months == 0) {
+        if (ohlc_history_subset.first != ohlc_history_subset.second) {
+            evaluation_plan.periods.push_back(get_evaluation_period(start_evalueation_timestamp_sec,
+                                                                    end_evaluation_timestamp_sec, // nowrap
+                                                                    ohlc_history_subset.first,    // nowrap
+                                                                    ohlc_history_subset.second));
+            evaluation_plan.periods.back().ohlc_range_index = ohlc_range_index;
+        }
+        // Single window covers whole evaluation
+        if (sim_evaluation_config.evaluation_window.count == 0) {
             break;
         }
     }
+    return evaluation_plan;
+}
+
+// Gains of simulation result over evaluation_period.
+SimulatorEvaluationResult::TimePeriod get_time_period(const EvaluationPeriod &evaluation_period,
+                                                      const SimulationResult &sim_result) {
+    SimulatorEvaluationResult::TimePeriod time_period;
+    time_period.start_timestamp_sec = evaluation_period.start_timestamp_sec;
+    time_period.end_timestamp_sec = evaluation_period.end_timestamp_sec;
+    time_period.result = sim_result;
+    assert(sim_result.start_value > 0);
+    time_period.final_gain = (sim_result.end_value / sim_result.start_value);
+    time_period.base_final_gain = evaluation_period.base_final_gain;
+    return time_period;
+}
+
+SimulatorEvaluationResult::TimePeriod evaluate_period(const AccountConfig &account_config,             // nowrap
+                                                      const EvaluationPeriod &evaluation_period,       // nowrap
+                                                      const SimulatorDispatcher &simulator_dispatcher, // nowrap
+                                                      SimulationLogger *logger) {
+    SimulationResult sim_result = simulator_dispatcher.execute_simulation(account_config,    // nowrap
+                                                                          evaluation_period, // nowrap
+                                                                          {}, false,         // nowrap
+                                                                          logger);
+    return get_time_period(evaluation_period, sim_result);
+}
+
+std::vector<SimulatorEvaluationResult::TimePeriod>
+evaluate_batch_period(const AccountConfig &account_config,       // nowrap
+                      const EvaluationPeriod &evaluation_period, // nowrap
+                      const std::vector<const SimulatorDispatcher *> &simulator_dispatchers) {
+    std::unique_ptr<BatchTradeSimulator> batch_trade_simulator =
+        simulator_dispatchers.front()->new_batch_simulator(simulator_dispatchers);
+    assert(batch_trade_simulator && batch_trade_simulator->size() == simulator_dispatchers.size());
+    const std::vector<SimulationResult> sim_results =
+        execute_batch_trade_simulation(account_config, evaluation_period, {}, *batch_trade_simulator);
+    std::vector<SimulatorEvaluationResult::TimePeriod> time_periods;
+    time_periods.reserve(sim_results.size());
+    for (const SimulationResult &sim_result : sim_results)
+        time_periods.push_back(get_time_period(evaluation_period, sim_result));
+    return time_periods;
+}
 
+void update_evaluation_score(SimulatorEvaluationResult &simulation_eval_result) {
     simulation_eval_result.score = get_geometric_avrage_of_container(
         simulation_eval_result.periods,
         [](const SimulatorEvaluationResult::TimePeriod &period) { return period.final_gain / period.base_final_gain; });
@@ -158,35 +252,226 @@ SimulatorEvaluationResult evaluate_trade_simulator(const AccountConfig &account_
     simulation_eval_result.avg_total_fee = get_avrage_of_container(
         simulation_eval_result.periods,
         [](const SimulatorEvaluationResult::TimePeriod &period) { return period.result.total_fee; });
+}
+
+SimulatorEvaluationResult evaluate_trade_simulator(const AccountConfig &account_config,             // nowrap
+                                                   const EvaluationPlan &evaluation_plan,           // nowrap
+                                                   const FearAndGreed *fear_and_greed_input,        // nowrap
+                                                   const SimulatorDispatcher &simulator_dispatcher, // nowrap
+                                                   SimulationLogger *logger) {
+    SimulatorEvaluationResult simulation_eval_result;
+    simulation_eval_result.account_config = account_config;
+    simulation_eval_result.sim_evaluation_config = evaluation_plan.sim_evaluation_config;
+    simulation_eval_result.name = simulator_dispatcher.get_names();
+    simulation_eval_result.periods.reserve(evaluation_plan.periods.size());
+    for (const EvaluationPeriod &evaluation_period : evaluation_plan.periods) {
+        simulation_eval_result.periods.push_back(
+            evaluate_period(account_config, evaluation_period, simulator_dispatcher, logger));
+    }
+    update_evaluation_score(simulation_eval_result);
+    return simulation_eval_result;
+}
+
+SimulatorEvaluationResult evaluate_trade_simulator(const AccountConfig &account_config,             // nowrap
+                                                   const EvaluationPlan &evaluation_plan,           // nowrap
+                                                   const FearAndGreed *fear_and_greed_input,        // nowrap
+                                                   const SimulatorDispatcher &simulator_dispatcher, // nowrap
+                                                   ThreadPool &thread_pool) {
+    const std::vector<EvaluationPeriod> &evaluation_periods = evaluation_plan.periods;
+    SimulatorEvaluationResult simulation_eval_result;
+    simulation_eval_result.account_config = account_config;
+    simulation_eval_result.sim_evaluation_config = evaluation_plan.sim_evaluation_config;
+    simulation_eval_result.name = simulator_dispatcher.get_names();
+    // Every task writes only its own period
+    simulation_eval_result.periods.resize(evaluation_periods.size());
+
+    // Longest period first, so that the short ones balance the end of the evaluation
+    std::vector<size_t> period_order(evaluation_periods.size());
+    std::iota(period_order.begin(), period_order.end(), 0);
+    std::stable_sort(period_order.begin(), period_order.end(), [&](size_t lhs, size_t rhs) {
+        return evaluation_periods[lhs].size() > evaluation_periods[rhs].size();
+    });
+
+    std::vector<std::future<void>> period_futures;
+    period_futures.reserve(evaluation_periods.size());
+    for (size_t period_index : period_order) {
+        period_futures.emplace_back(thread_pool.submit([&, period_index]() {
+            simulation_eval_result.periods[period_index] = evaluate_period(
+                account_config, evaluation_periods[period_index], simulator_dispatcher, /*logger=*/nullptr);
+        }));
+    }
+    for (auto &period_future : period_futures) {
+        period_future.get();
+    }
+    update_evaluation_score(simulation_eval_result);
     return simulation_eval_result;
 }
 
 std::vector<SimulatorEvaluationResult> evaluate_combination_of_trade_simulators(
     const AccountConfig &account_config,
-    const SimEvaluationConfig &sim_evaluation_config, // nowrap
-    const OhlcHistory &ohlc_history,                  // nowrap
+    const EvaluationPlan &evaluation_plan, // nowrap
     const FearAndGreed *fear_and_greed_input,
-    const std::vector<std::unique_ptr<SimulatorDispatcher>> &simulator_dispatchers) {
-    std::vector<SimulatorEvaluationResult> sim_evaluation_results;
-
-    /*
-     * Use future for multi threading
-     * TODO :- convert this to std::thread and Pass down a parameter from command line argument for number of thread to
-     * be used.
-     */
-    std::vector<std::future<SimulatorEvaluationResult>> sim_evaluation_result_futures;
-    for (const auto &sim_dispatcher : simulator_dispatchers) {
-        const SimulatorDispatcher &simulator_dispatcher = *sim_dispatcher;
-        sim_evaluation_result_futures.emplace_back(std::async([&]() {
-            return evaluate_trade_simulator(account_config, sim_evaluation_config, ohlc_history, {},
-                                            simulator_dispatcher,
-                                            /*logger=*/nullptr);
+    const std::vector<const SimulatorDispatcher *> &simulator_dispatchers, // nowrap
+    ThreadPool &thread_pool) {
+    // Periods are shared (read only) by all the tasks
+    const std::vector<EvaluationPeriod> &evaluation_periods = evaluation_plan.periods;
+
+    std::vector<SimulatorEvaluationResult> sim_evaluation_results(simulator_dispatchers.size());
+    for (size_t i = 0; i < simulator_dispatchers.size(); ++i) {
+        sim_evaluation_results[i].account_config = account_config;
+        sim_evaluation_results[i].sim_evaluation_config = evaluation_plan.sim_evaluation_config;
+        sim_evaluation_results[i].name = simulator_dispatchers[i]->get_names();
+        // Every task writes only its own periods
+        sim_evaluation_results[i].periods.resize(evaluation_periods.size());
+    }
+
+    // Consecutive simulators of the same strategy run as lanes of one batch simulator, others one by one
+    struct SimulatorGroup {
+        size_t first_index;
+        std::vector<const SimulatorDispatcher *> dispatchers;
+        bool batched;
+    };
+    std::vector<SimulatorGroup> simulator_groups;
+    for (size_t i = 0; i < simulator_dispatchers.size();) {
+        SimulatorGroup group{i, {}, false};
+        const size_t group_end = std::min(simulator_dispatchers.size(), i + MaxBatchTradeSimulatorLanes);
+        for (size_t j = i; j < group_end; ++j)
+            group.dispatchers.push_back(simulator_dispatchers[j]);
+        group.batched =
+            group.dispatchers.size() > 1 && group.dispatchers.front()->new_batch_simulator(group.dispatchers);
+        if (!group.batched)
+            group.dispatchers.resize(1);
+        i += group.dispatchers.size();
+        simulator_groups.push_back(std::move(group));
+    }
+
+    // Longest expected (ticks of the period times lanes) first, so that the short ones balance the end of the sweep
+    std::vector<std::pair<size_t, size_t>> tasks;
+    tasks.reserve(simulator_groups.size() * evaluation_periods.size());
+    for (size_t period_index = 0; period_index < evaluation_periods.size(); ++period_index)
+        for (size_t group_index = 0; group_index < simulator_groups.size(); ++group_index)
+            tasks.emplace_back(group_index, period_index);
+    auto expected_cost = [&](const std::pair<size_t, size_t> &task) {
+        return evaluation_periods[task.second].size() * simulator_groups[task.first].dispatchers.size();
+    };
+    std::stable_sort(tasks.begin(), tasks.end(),
+                     [&](const auto &lhs, const auto &rhs) { return expected_cost(lhs) > expected_cost(rhs); });
+
+    // Every (simulator group, period) pair is a task of the thread pool
+    std::vector<std::future<void>> period_futures;
+    period_futures.reserve(tasks.size());
+    for (const auto &task : tasks) {
+        const SimulatorGroup &group = simulator_groups[task.first];
+        const size_t period_index = task.second;
+        period_futures.emplace_back(thread_pool.submit([&, period_index]() {
+            const EvaluationPeriod &evaluation_period = evaluation_periods[period_index];
+            if (!group.batched) {
+                sim_evaluation_results[group.first_index].periods[period_index] =
+                    evaluate_period(account_config, evaluation_period, *group.dispatchers.front(),
+                                    /*logger=*/nullptr);
+                return;
+            }
+            std::vector<SimulatorEvaluationResult::TimePeriod> time_periods =
+                evaluate_batch_period(account_config, evaluation_period, group.dispatchers);
+            for (size_t lane = 0; lane < time_periods.size(); ++lane)
+                sim_evaluation_results[group.first_index + lane].periods[period_index] = time_periods[lane];
         }));
     }
-    for (auto &eval_result_future : sim_evaluation_result_futures) {
-        sim_evaluation_results.emplace_back(eval_result_future.get());
+    for (auto &period_future : period_futures) {
+        period_future.get();
+    }
+    for (SimulatorEvaluationResult &sim_evaluation_result : sim_evaluation_results) {
+        update_evaluation_score(sim_evaluation_result);
     }
     return sim_evaluation_results;
 }
 
-} // namespace back_trader
\ No newline at end of file
+std::vector<SimulatorEvaluationResult> evaluate_combination_of_trade_simulators(
+    const AccountConfig &account_config,
+    const EvaluationPlan &evaluation_plan, // nowrap
+    const FearAndGreed *fear_and_greed_input,
+    const std::vector<std::unique_ptr<SimulatorDispatcher>> &simulator_dispatchers, // nowrap
+    ThreadPool &thread_pool) {
+    std::vector<const SimulatorDispatcher *> dispatchers;
+    dispatchers.reserve(simulator_dispatchers.size());
+    for (const auto &simulator_dispatcher : simulator_dispatchers)
+        dispatchers.push_back(simulator_dispatcher.get());
+    return evaluate_combination_of_trade_simulators(account_config, evaluation_plan, fear_and_greed_input, dispatchers,
+                                                    thread_pool);
+}
+
+// Plan of period_count periods of evaluation_plan spread evenly over its time range.
+EvaluationPlan get_evaluation_subplan(const EvaluationPlan &evaluation_plan, size_t period_count) {
+    assert(period_count > 0 && period_count <= evaluation_plan.periods.size());
+    EvaluationPlan evaluation_subplan;
+    evaluation_subplan.sim_evaluation_config = evaluation_plan.sim_evaluation_config;
+    evaluation_subplan.periods.reserve(period_count);
+    const size_t total_period_count = evaluation_plan.periods.size();
+    // Middle period of every of period_count equal parts
+    for (size_t i = 0; i < period_count; ++i)
+        evaluation_subplan.periods.push_back(
+            evaluation_plan.periods[(2 * i + 1) * total_period_count / (2 * period_count)]);
+    return evaluation_subplan;
+}
+
+std::vector<SimulatorEvaluationResult> evaluate_combination_of_trade_simulators_with_halving(
+    const AccountConfig &account_config,
+    const EvaluationPlan &evaluation_plan, // nowrap
+    const FearAndGreed *fear_and_greed_input,
+    const std::vector<std::unique_ptr<SimulatorDispatcher>> &simulator_dispatchers, // nowrap
+    size_t reduction_factor,                                                        // nowrap
+    size_t min_survivors,                                                           // nowrap
+    ThreadPool &thread_pool) {
+    assert(reduction_factor > 1);
+    const size_t total_period_count = evaluation_plan.periods.size();
+    std::vector<const SimulatorDispatcher *> survivors;
+    survivors.reserve(simulator_dispatchers.size());
+    for (const auto &simulator_dispatcher : simulator_dispatchers)
+        survivors.push_back(simulator_dispatcher.get());
+    if (total_period_count == 0)
+        return evaluate_combination_of_trade_simulators(account_config, evaluation_plan, fear_and_greed_input,
+                                                        survivors, thread_pool);
+
+    // Number of pruning rounds until min_survivors are left, first round runs on total / reduction_factor^rounds
+    size_t rounds = 0;
+    size_t first_round_divisor = 1;
+    for (size_t survivor_count = survivors.size();
+         survivor_count / reduction_factor >= min_survivors && first_round_divisor < total_period_count;
+         survivor_count /= reduction_factor) {
+        ++rounds;
+        first_round_divisor *= reduction_factor;
+    }
+
+    size_t period_divisor = first_round_divisor;
+    for (size_t round = 0;; ++round) {
+        const size_t period_count = std::max<size_t>(1, total_period_count / period_divisor);
+        logInfo(string_format("Successive halving round ", round + 1, "/", rounds + 1, ": ", survivors.size(),
+                              " simulators on ", period_count, " periods"));
+        if (period_count == total_period_count)
+            return evaluate_combination_of_trade_simulators(account_config, evaluation_plan, fear_and_greed_input,
+                                                            survivors, thread_pool);
+        std::vector<SimulatorEvaluationResult> round_results = evaluate_combination_of_trade_simulators(
+            account_config, get_evaluation_subplan(evaluation_plan, period_count), fear_and_greed_input, survivors,
+            thread_pool);
+
+        // Best first, ties keep the order of the dispatchers
+        std::vector<size_t> ranking(survivors.size());
+        std::iota(ranking.begin(), ranking.end(), 0);
+        std::stable_sort(ranking.begin(), ranking.end(), [&](size_t lhs, size_t rhs) {
+            return round_results[lhs].score > round_results[rhs].score;
+        });
+        const size_t survivor_count =
+            std::min(survivors.size(),
+                     std::max(min_survivors, (survivors.size() + reduction_factor - 1) / reduction_factor));
+        ranking.resize(survivor_count);
+        // Back to the order of the dispatchers, consecutive simulators of the same strategy are batched
+        std::sort(ranking.begin(), ranking.end());
+        std::vector<const SimulatorDispatcher *> next_survivors;
+        next_survivors.reserve(survivor_count);
+        for (size_t index : ranking)
+            next_survivors.push_back(survivors[index]);
+        survivors = std::move(next_survivors);
+        period_divisor = std::max<size_t>(1, period_divisor / reduction_factor);
+    }
+}
+} // namespace back_trader
@@ -1,40 +1,308 @@
 #pragma once
 #include "../logs/simulation_log.hpp"
 #include "simulation_types.hpp"
+#include <algorithm>
 #include <base_header.hpp>
+#include <cassert>
+#include <cstddef>
+#include <limits>
 #include <memory>
+#include <vector>
 
 namespace back_trader {
+// Maximum number of simulators evaluated together as lanes of one BatchTradeSimulator.
+constexpr size_t MaxBatchTradeSimulatorLanes = 16;
+
+// Returns the last OHLC tick with volume (the last update of simulator), ohlc_end if there is none.
+OhlcHistoryView::const_iterator find_last_simulator_update(OhlcHistoryView::const_iterator ohlc_begin,
+                                                           OhlcHistoryView::const_iterator ohlc_end);
+
+// Evaluation period over [ohlc_begin, ohlc_end) (not empty) of history between the timestamps.
+EvaluationPeriod get_evaluation_period(std::time_t start_timestamp_sec,            // nowrap
+                                       std::time_t end_timestamp_sec,              // nowrap
+                                       OhlcHistoryView::const_iterator ohlc_begin, // nowrap
+                                       OhlcHistoryView::const_iterator ohlc_end);
+
+// Result of simulation over evaluation_period from the account state at the last update of simulator.
+SimulationResult get_simulation_result(const AccountConfig &account_config,       // nowrap
+                                       const EvaluationPeriod &evaluation_period, // nowrap
+                                       float end_base_balance,                    // nowrap
+                                       float end_quote_balance,                   // nowrap
+                                       float total_fee,                           // nowrap
+                                       int total_order);
+
 /*
- *Execute and instance of simulator(strategy) on range of OHLC history.
+ * Skips ticks [ohlc_begin, ohlc_end) while trade_simulator.can_skip the range of the ticks (nothing fills and the
+ * simulator only remembers the ticks), returns the first tick which has to be executed. With ohlc_range_index (of the
+ * history of the ticks) the skipped ticks are found by exponential and binary search in O(log n) ranges instead of
+ * extending the range tick by tick, can_skip has to be false for every range wider than a range it's false for.
  */
-SimulationResult execute_trade_simulation(const AccountConfig &account_config,      // nowrap
-                                          OhlcHistory::const_iterator ohlc_begin,   // nowrap
-                                          OhlcHistory::const_iterator ohlc_end,     // nowrap
-                                          const FearAndGreed *fear_and_greed_input, // nowrap
-                                          bool fast_execute,                        // nowrap
-                                          TradeSimulator &trade_simulator,          // nowrap
+template <typename Simulator>
+OhlcHistoryView::const_iterator skip_steady_ticks(Simulator &trade_simulator,                   // nowrap
+                                                  OhlcHistoryView::const_iterator ohlc_begin, // nowrap
+                                                  OhlcHistoryView::const_iterator ohlc_end,   // nowrap
+                                                  const OhlcRangeIndex *ohlc_range_index) {
+    OhlcHistoryView::const_iterator skip_end = ohlc_begin;
+    if (ohlc_range_index) {
+        if (ohlc_begin == ohlc_end || !trade_simulator.can_skip(OhlcRange{ohlc_begin->low, ohlc_begin->high}))
+            return ohlc_begin;
+        const size_t max_skip_count = ohlc_end - ohlc_begin;
+        size_t skip_count = 1;
+        size_t step = 1;
+        // Double the skipped ticks while they can be skipped, then halve the step down to a tick
+        while (skip_count + step <= max_skip_count &&
+               trade_simulator.can_skip(ohlc_range_index->get_range(ohlc_begin, ohlc_begin + skip_count + step))) {
+            skip_count += step;
+            step *= 2;
+        }
+        while (step > 1) {
+            step /= 2;
+            if (skip_count + step <= max_skip_count &&
+                trade_simulator.can_skip(ohlc_range_index->get_range(ohlc_begin, ohlc_begin + skip_count + step)))
+                skip_count += step;
+        }
+        skip_end = ohlc_begin + skip_count;
+    } else {
+        OhlcRange ohlc_range{std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()};
+        for (; skip_end != ohlc_end; ++skip_end) {
+            const OhlcRange next_range{std::min(ohlc_range.low, skip_end->low),
+                                       std::max(ohlc_range.high, skip_end->high)};
+            if (!trade_simulator.can_skip(next_range))
+                break;
+            ohlc_range = next_range;
+        }
+    }
+    // Simulator is updated only on ticks with volume
+    const OhlcHistoryView::const_iterator last_skipped_update = find_last_simulator_update(ohlc_begin, skip_end);
+    if (last_skipped_update != skip_end)
+        trade_simulator.skip(*last_skipped_update);
+    return skip_end;
+}
+
+/*
+ * Execute an instance of simulator (strategy) on evaluation period. Simulator is the type of trade_simulator, when
+ * it's a final strategy class its update is called directly (and inlined) instead of through the vtable on every tick.
+ * LoggerPolicy is SimulationLogger or NoSimulationLogger, with NoSimulationLogger logging is compiled out of the loop.
+ * After the setup the loop doesn't allocate (checked when built with COUNT_ALLOCATIONS). Without logging the ticks
+ * which the simulator can skip (see TradeSimulator::can_skip) are skipped.
+ */
+template <typename Simulator, typename LoggerPolicy>
+SimulationResult execute_trade_simulation(const AccountConfig &account_config,       // nowrap
+                                          const EvaluationPeriod &evaluation_period, // nowrap
+                                          const FearAndGreed *fear_and_greed_input,  // nowrap
+                                          bool fast_execute,                         // nowrap
+                                          Simulator &trade_simulator,                // nowrap
+                                          LoggerPolicy &logger) {
+    const OhlcHistoryView::const_iterator ohlc_begin = evaluation_period.ohlc_begin;
+    const OhlcHistoryView::const_iterator ohlc_end = evaluation_period.ohlc_end;
+    const OhlcHistoryView::const_iterator last_update_it = evaluation_period.ohlc_last_update;
+    // No data to process
+    if (last_update_it == ohlc_end)
+        return {};
+
+    // Every simulator (strategy) would have it's own account to track the transaction
+    SimulationAccount account;
+    account.init_account(account_config);
+    // Good till cancelled orders, only for simulators keeping resting orders
+    OrderBook order_book(trade_simulator.max_resting_orders());
+    const bool use_order_book = order_book.capacity() > 0;
+    if (use_order_book)
+        trade_simulator.attach_order_book(&order_book);
+    std::vector<Order> orders;
+    constexpr size_t DispatchedOrderReserve = 8;
+    orders.reserve(DispatchedOrderReserve);
+    // TODO :- fill fear_and_greed_input signals according to each ohlc tick
+    const std::vector<float> fear_and_greed_input_signals;
+    int count_executed_orders = 0;
+    SimulationResult simulation_result;
+    [[maybe_unused]] const size_t setup_allocation_count = thread_allocation_count();
+
+    // Ticks after the last update only execute the orders, which doesn't change the result. Needed only for the log.
+    const OhlcHistoryView::const_iterator simulation_end = LoggerPolicy::Enabled ? ohlc_end : last_update_it + 1;
+    for (auto ohlc_it = ohlc_begin; ohlc_it != simulation_end; ++ohlc_it) {
+        const OhlcTick &ohlc_tick = *ohlc_it;
+
+        // Log current ohlc and account
+        if constexpr (LoggerPolicy::Enabled) {
+            logger.log_account_state(ohlc_tick, account);
+        }
+
+        /*
+         *  The trade simulator was updated on the previous OHLC tick OHLC_HISTORY[i-1] and emitted
+         *  "orders". There are no other active orders on the exchange.
+         *  Execute (or cancel) "orders" on the current OHLC tick OHLC_HISTORY[i].
+         */
+
+        if (use_order_book) {
+            count_executed_orders += order_book.execute(account_config, ohlc_tick, account, [&](const Order &order) {
+                if constexpr (LoggerPolicy::Enabled)
+                    logger.log_account_state(ohlc_tick, account, order);
+            });
+        }
+        for (const Order &order : orders) {
+            const bool executed = account.execute_order(account_config, order, ohlc_tick);
+            if (executed) {
+                ++count_executed_orders;
+                // Log only in case when order is executed
+                if constexpr (LoggerPolicy::Enabled)
+                    logger.log_account_state(ohlc_tick, account, order);
+            }
+        }
+
+        if (ohlc_tick.volume == 0) {
+            /*
+             * zero volume on ohlc tick is missing price history so we keep our order as what was generated for previous
+             * order In real world exchange api is down let's pause for a bit.
+             */
+            continue;
+        }
+
+        // TODO :- handle calculation of volatility according to fast_execute
+        if (ohlc_it == last_update_it)
+            simulation_result =
+                get_simulation_result(account_config, evaluation_period, get_base_balance(account),
+                                      get_quote_balance(account), get_total_fee(account), count_executed_orders);
+
+        // as we have already executed previous tick order let update for current ohlc tick
+        orders.clear();
+        trade_simulator.update(ohlc_tick, fear_and_greed_input_signals, get_base_balance(account),
+                               get_quote_balance(account), orders);
+        if constexpr (LoggerPolicy::Enabled)
+            logger.log_simulator_state(trade_simulator);
+
+        /*
+         * Without logging ticks on which nothing happens are skipped, the last update is always executed for the
+         * result. can_skip covers only the emitted orders, so not while resting orders can be triggered.
+         */
+        if constexpr (!LoggerPolicy::Enabled) {
+            if (ohlc_it < last_update_it && order_book.empty())
+                ohlc_it = skip_steady_ticks(trade_simulator, ohlc_it + 1, last_update_it,
+                                            evaluation_period.ohlc_range_index) -
+                          1;
+        }
+    }
+    // Stream buffers of the logger are allocated on the first write, so only the loop without logging is checked
+    if constexpr (!LoggerPolicy::Enabled)
+        assert(thread_allocation_count() == setup_allocation_count);
+    return simulation_result;
+}
+
+// Execute with logger when it's not null, otherwise with logging compiled out.
+template <typename Simulator>
+SimulationResult execute_trade_simulation(const AccountConfig &account_config,       // nowrap
+                                          const EvaluationPeriod &evaluation_period, // nowrap
+                                          const FearAndGreed *fear_and_greed_input,  // nowrap
+                                          bool fast_execute,                         // nowrap
+                                          Simulator &trade_simulator,                // nowrap
+                                          SimulationLogger *logger) {
+    if (logger)
+        return execute_trade_simulation(account_config, evaluation_period, fear_and_greed_input, fast_execute,
+                                        trade_simulator, *logger);
+    NoSimulationLogger no_logger;
+    return execute_trade_simulation(account_config, evaluation_period, fear_and_greed_input, fast_execute,
+                                    trade_simulator, no_logger);
+}
+
+/*
+ * Execute an instance of simulator (strategy) on evaluation period through TradeSimulator interface (virtual update on
+ * every tick).
+ */
+SimulationResult execute_trade_simulation(const AccountConfig &account_config,       // nowrap
+                                          const EvaluationPeriod &evaluation_period, // nowrap
+                                          const FearAndGreed *fear_and_greed_input,  // nowrap
+                                          bool fast_execute,                         // nowrap
+                                          TradeSimulator &trade_simulator,           // nowrap
                                           SimulationLogger *logger);
 
 /*
- * Evalulate single simulator
+ * Execute all lanes of batch_trade_simulator on evaluation period in single pass, returns result of every lane.
+ * Results are the same as execute_trade_simulation of the simulator of each lane. Ticks are skipped only when every
+ * lane can skip them (see BatchTradeSimulator::can_skip).
  */
-SimulatorEvaluationResult evaluate_trade_simulator(const AccountConfig &account_config,              // nowrap
-                                                   const SimEvaluationConfig &sim_evaluation_config, // nowrap
-                                                   const OhlcHistory &ohlc_histroy,                  // nowrap
-                                                   const FearAndGreed *fear_and_greed_input,         // nowrap
-                                                   const SimulatorDispatcher &simulator_dispatcher,  // nowrap
+std::vector<SimulationResult> execute_batch_trade_simulation(const AccountConfig &account_config,       // nowrap
+                                                             const EvaluationPeriod &evaluation_period, // nowrap
+                                                             const FearAndGreed *fear_and_greed_input,  // nowrap
+                                                             BatchTradeSimulator &batch_trade_simulator);
+
+// Returns timestamp_sec moved forward by time_span (times times).
+std::time_t add_time_span(std::time_t timestamp_sec, const EvaluationTimeSpan &time_span, int32_t times = 1);
+
+/*
+ Returns the plan of the non empty evaluation periods (windows) of sim_evaluation_config over ohlc_history.
+ ohlc_range_index (of ohlc_history or of the whole history it's a view into, may be null) is used by simulations of
+ the periods to skip ticks in O(log n).
+*/
+EvaluationPlan get_evaluation_plan(const SimEvaluationConfig &sim_evaluation_config, // nowrap
+                                   const OhlcHistoryView &ohlc_history,              // nowrap
+                                   const OhlcRangeIndex *ohlc_range_index = nullptr);
+
+// Executes a new simulator of simulator_dispatcher over single evaluation period (statically dispatched loop).
+SimulatorEvaluationResult::TimePeriod evaluate_period(const AccountConfig &account_config,             // nowrap
+                                                      const EvaluationPeriod &evaluation_period,       // nowrap
+                                                      const SimulatorDispatcher &simulator_dispatcher, // nowrap
+                                                      SimulationLogger *logger);
+
+// Executes a new batch simulator of simulator_dispatchers over single evaluation period, one period per dispatcher.
+std::vector<SimulatorEvaluationResult::TimePeriod>
+evaluate_batch_period(const AccountConfig &account_config,       // nowrap
+                      const EvaluationPeriod &evaluation_period, // nowrap
+                      const std::vector<const SimulatorDispatcher *> &simulator_dispatchers);
+
+// Computes score and averages of simulation_eval_result from its periods.
+void update_evaluation_score(SimulatorEvaluationResult &simulation_eval_result);
+
+/*
+ * Evalulate single simulator over periods of evaluation_plan
+ */
+SimulatorEvaluationResult evaluate_trade_simulator(const AccountConfig &account_config,             // nowrap
+                                                   const EvaluationPlan &evaluation_plan,           // nowrap
+                                                   const FearAndGreed *fear_and_greed_input,        // nowrap
+                                                   const SimulatorDispatcher &simulator_dispatcher, // nowrap
                                                    SimulationLogger *logger);
 
+/*
+ * Evalulate single simulator without logger, every evaluation period (window) is a task of thread_pool submitted
+ * longest first. Use it for many (overlapping) windows.
+ */
+SimulatorEvaluationResult evaluate_trade_simulator(const AccountConfig &account_config,             // nowrap
+                                                   const EvaluationPlan &evaluation_plan,           // nowrap
+                                                   const FearAndGreed *fear_and_greed_input,        // nowrap
+                                                   const SimulatorDispatcher &simulator_dispatcher, // nowrap
+                                                   ThreadPool &thread_pool);
+
 /*
  * Evaluate combination (Strategy sim we have use all combination of
  * config ex:- alpha and epsilon to generate list of
- * simulators) of simulatators no multi threads;
+ * simulators) of simulatators. Simulators with batched version are grouped by up to MaxBatchTradeSimulatorLanes lanes,
+ * every (simulator group, period) pair is a task of thread_pool submitted longest first, periods are reassembled into
+ * the result of their simulator;
  */
 std::vector<SimulatorEvaluationResult> evaluate_combination_of_trade_simulators(
     const AccountConfig &account_config,
-    const SimEvaluationConfig &sim_evaluation_config, // nowrap
-    const OhlcHistory &ohlc_history,                  // nowrap
+    const EvaluationPlan &evaluation_plan, // nowrap
+    const FearAndGreed *fear_and_greed_input,
+    const std::vector<const SimulatorDispatcher *> &simulator_dispatchers, // nowrap
+    ThreadPool &thread_pool);
+
+std::vector<SimulatorEvaluationResult> evaluate_combination_of_trade_simulators(
+    const AccountConfig &account_config,
+    const EvaluationPlan &evaluation_plan, // nowrap
+    const FearAndGreed *fear_and_greed_input,
+    const std::vector<std::unique_ptr<SimulatorDispatcher>> &simulator_dispatchers, // nowrap
+    ThreadPool &thread_pool);
+
+/*
+ * Successive halving over combination of simulators. First round evaluates all simulators on an evenly spread subset of
+ * periods of evaluation_plan, every next round keeps the best 1/reduction_factor of them by score (at least
+ * min_survivors) and evaluates them on reduction_factor times more periods, until the last round on all the periods.
+ * Returns results of the last round (survivors evaluated on all the periods), pruned simulators are dropped.
+ */
+std::vector<SimulatorEvaluationResult> evaluate_combination_of_trade_simulators_with_halving(
+    const AccountConfig &account_config,
+    const EvaluationPlan &evaluation_plan, // nowrap
     const FearAndGreed *fear_and_greed_input,
-    const std::vector<std::unique_ptr<SimulatorDispatcher>> &simulator_dispatchers);
+    const std::vector<std::unique_ptr<SimulatorDispatcher>> &simulator_dispatchers, // nowrap
+    size_t reduction_factor,                                                        // nowrap
+    size_t min_survivors,                                                           // nowrap
+    ThreadPool &thread_pool);
 } // namespace back_trader
\ No newline at end of file
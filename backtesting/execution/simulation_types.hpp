@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <ctime>
 #include <string>
+#include <vector>
 namespace back_trader {
 // Result of trade simulation over a region of the OHLC history.
 struct SimulationResult {
@@ -33,18 +34,63 @@ struct SimulationResult {
     float simulator_volatility;
 };
 
+// Length of time in days, weeks or (calendar) months.
+struct EvaluationTimeSpan {
+    enum class Unit {
+        DAY,
+        WEEK,
+        MONTH,
+    };
+    int32_t count;
+    Unit unit;
+};
+
 struct SimEvaluationConfig {
     // Start timestamp (in sec).
     std::time_t start_timestamp_sec;
     // Ending timestamp (in sec).
     std::time_t end_timestamp_sec;
-    // execution period (in months).
-    int32_t evaluation_period_months;
+    // Length of every evaluation window (period), zero count is single window over the whole [start, end).
+    EvaluationTimeSpan evaluation_window;
+    // Step between starts of consecutive windows, windows overlap when the step is shorter than the window.
+    EvaluationTimeSpan evaluation_step;
     // When true, avoids computing volatility (to speed up the computation).
     // This is useful when evaluating a combination of traders in parallel.
     bool fast_execute;
 };
 
+// Evaluation period of SimEvaluationConfig with the range of OHLC history it covers.
+struct EvaluationPeriod {
+    // Start timestamp of the period (included).
+    std::time_t start_timestamp_sec;
+    // End timestamp of the period (excluded).
+    std::time_t end_timestamp_sec;
+    OhlcHistoryView::const_iterator ohlc_begin;
+    OhlcHistoryView::const_iterator ohlc_end;
+    // Last OHLC tick with volume (last update of simulators), ohlc_end if there is none.
+    OhlcHistoryView::const_iterator ohlc_last_update;
+    // Close price of the first and the last OHLC tick.
+    float start_price;
+    float end_price;
+    // gain of the baseline (Buy and HODL) method.
+    float base_final_gain;
+    // Range index of the history of the period (shared by the plan), nullptr if there is none.
+    const OhlcRangeIndex *ohlc_range_index = nullptr;
+
+    // Number of OHLC ticks, the expected cost of simulating the period.
+    size_t size() const { return ohlc_end - ohlc_begin; }
+};
+
+/*
+ Evaluation periods of SimEvaluationConfig over OHLC history with everything which doesn't depend on the simulator.
+ Built once per evaluation and only read after, shared by all simulators and worker threads.
+*/
+struct EvaluationPlan {
+    SimEvaluationConfig sim_evaluation_config;
+    // Non empty periods in order of time.
+    std::vector<EvaluationPeriod> periods;
+};
+
 // Result of trade simulation over given execution config.
 struct SimulatorEvaluationResult {
     AccountConfig account_config;
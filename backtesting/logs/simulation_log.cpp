@@ -1,57 +1,73 @@
 #include "simulation_log.hpp"
-#include <string>
-#include <variant>
+#include <cstdio>
 
-using namespace common_util;
 namespace back_trader {
 SimulationLogger::SimulationLogger(std::ostream *account_os, std::ostream *simulater_os)
     : account_state_os(account_os), simulator_state_os(simulater_os){};
 
-std::string SimulationLogger::ohlc_to_csv(const OhlcTick &ohlc_tick) const {
-    return string_format(ohlc_tick.timestamp_sec, ',', // nowrap
-                         ohlc_tick.open, ',',          // nowrap
-                         ohlc_tick.high, ',',          // nowrap
-                         ohlc_tick.low, ',',           // nowrap
-                         ohlc_tick.close, ',',         // nowrap
-                         ohlc_tick.volume);
+void SimulationLogger::write_ohlc_csv(std::ostream &os, const OhlcTick &ohlc_tick) const {
+    os << ohlc_tick.timestamp_sec << ',' // nowrap
+       << ohlc_tick.open << ','          // nowrap
+       << ohlc_tick.high << ','          // nowrap
+       << ohlc_tick.low << ','           // nowrap
+       << ohlc_tick.close << ','         // nowrap
+       << ohlc_tick.volume;
 }
-std::string SimulationLogger::account_to_csv(const Account &account) const {
-    return string_format(account.base_balance, ',',  // nowrap
-                         account.quote_balance, ',', // nowrap
-                         account.total_fee);
+void SimulationLogger::write_account_csv(std::ostream &os, const SimulationAccount &account) const {
+    os << get_base_balance(account) << ','  // nowrap
+       << get_quote_balance(account) << ',' // nowrap
+       << get_total_fee(account);
 }
-std::string SimulationLogger::order_to_csv(const Order &order) const {
-    return string_format(order_type_to_string(order.type), ',', // nowrap // nowrap
-                         order_side_to_string(order.side),
-                         ',', // nowrap                                         // nowrap
-                         (std::holds_alternative<Order::BaseAmount>(order.amount)
-                              ? std::to_string((std::get<Order::BaseAmount>(order.amount).base_amount))
-                              : ""),
-                         ',', // nowrap
-                         (std::holds_alternative<Order::QuoteAmount>(order.amount)
-                              ? std::to_string((std::get<Order::QuoteAmount>(order.amount).quote_amount))
-                              : ""),
-                         ',', // nowrap
-                         order.price > 0.0f ? std::to_string(order.price) : "");
+
+// Same format as std::to_string (%f) into stack buffer.
+static void write_fixed(std::ostream &os, float value) {
+    char buffer[64];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%f", value);
+    os.write(buffer, length);
+}
+
+void SimulationLogger::write_order_csv(std::ostream &os, const Order &order) const {
+    os << order_type_to_string(order.type) << ',' << order_side_to_string(order.side) << ',';
+    if (order.amount_kind == Order::AmountKind::BASE)
+        write_fixed(os, order.amount);
+    os << ',';
+    if (order.amount_kind == Order::AmountKind::QUOTE)
+        write_fixed(os, order.amount);
+    os << ',';
+    if (order.price > 0.0f)
+        write_fixed(os, order.price);
 }
 
-std::string SimulationLogger::empty_order_csv() const { return ",,,,"; }
+void SimulationLogger::write_empty_order_csv(std::ostream &os) const { os << ",,,,"; }
 
 // log current account and ohlc state
-void SimulationLogger::log_account_state(const OhlcTick &ohlc_tick, const Account &account) {
-    if (account_state_os)
-        *account_state_os << ohlc_to_csv(ohlc_tick) << ',' << account_to_csv(account) << ',' << empty_order_csv()
-                          << '\n';
+void SimulationLogger::log_account_state(const OhlcTick &ohlc_tick, const SimulationAccount &account) {
+    if (!account_state_os)
+        return;
+    write_ohlc_csv(*account_state_os, ohlc_tick);
+    *account_state_os << ',';
+    write_account_csv(*account_state_os, account);
+    *account_state_os << ',';
+    write_empty_order_csv(*account_state_os);
+    *account_state_os << '\n';
 }
 // log current account, ohlc and order after execution
-void SimulationLogger::log_account_state(const OhlcTick &ohlc_tick, const Account &account, const Order &order) {
-    if (account_state_os)
-        *account_state_os << ohlc_to_csv(ohlc_tick) << ',' << account_to_csv(account) << ',' << order_to_csv(order)
-                          << '\n';
+void SimulationLogger::log_account_state(const OhlcTick &ohlc_tick, const SimulationAccount &account,
+                                         const Order &order) {
+    if (!account_state_os)
+        return;
+    write_ohlc_csv(*account_state_os, ohlc_tick);
+    *account_state_os << ',';
+    write_account_csv(*account_state_os, account);
+    *account_state_os << ',';
+    write_order_csv(*account_state_os, order);
+    *account_state_os << '\n';
 }
 
-void SimulationLogger::log_simulator_state(std::string_view simulator_internal_state) {
-    if (simulator_state_os)
-        *simulator_state_os << simulator_internal_state << '\n';
+void SimulationLogger::log_simulator_state(const TradeSimulator &trade_simulator) {
+    if (!simulator_state_os)
+        return;
+    trade_simulator.write_internal_state(*simulator_state_os);
+    *simulator_state_os << '\n';
 }
-} // namespace back_trader
\ No newline at end of file
+} // namespace back_trader
@@ -1,26 +1,37 @@
 #pragma once
 #include <base_header.hpp>
 #include <ostream>
-#include <string>
-#include <string_view>
 namespace back_trader {
 // Log results in seperater files rather than same system log this will allow to look into excution result progress
 // TODO :- Use log file to ploat how account state vary
 class SimulationLogger {
   public:
+    // Logger policy of execute_trade_simulation, logging is compiled in.
+    static constexpr bool Enabled = true;
     SimulationLogger(std::ostream *account_os, std::ostream *simulater_os);
     // log current account and ohlc state
-    void log_account_state(const OhlcTick &ohlc_tick, const Account &account);
+    void log_account_state(const OhlcTick &ohlc_tick, const SimulationAccount &account);
     // log current account, ohlc and order after execution
-    void log_account_state(const OhlcTick &ohlc_tick, const Account &account, const Order &order);
-    void log_simulator_state(std::string_view simulator_internal_state);
+    void log_account_state(const OhlcTick &ohlc_tick, const SimulationAccount &account, const Order &order);
+    // log internal state of trade simulator
+    void log_simulator_state(const TradeSimulator &trade_simulator);
 
   private:
     std::ostream *account_state_os;
     std::ostream *simulator_state_os;
-    std::string ohlc_to_csv(const OhlcTick &ohlc_tick) const;
-    std::string account_to_csv(const Account &account) const;
-    std::string order_to_csv(const Order &order) const;
-    std::string empty_order_csv() const;
+    // CSV fields are written straight into the stream, so logging a tick doesn't allocate.
+    void write_ohlc_csv(std::ostream &os, const OhlcTick &ohlc_tick) const;
+    void write_account_csv(std::ostream &os, const SimulationAccount &account) const;
+    void write_order_csv(std::ostream &os, const Order &order) const;
+    void write_empty_order_csv(std::ostream &os) const;
+};
+
+// Logger policy of execute_trade_simulation without logger, logging is compiled out of the simulation loop.
+class NoSimulationLogger {
+  public:
+    static constexpr bool Enabled = false;
+    void log_account_state(const OhlcTick &ohlc_tick, const SimulationAccount &account) {}
+    void log_account_state(const OhlcTick &ohlc_tick, const SimulationAccount &account, const Order &order) {}
+    void log_simulator_state(const TradeSimulator &trade_simulator) {}
 };
 } // namespace back_trader
\ No newline at end of file
@@ -1,15 +1,21 @@
 #include "common_util/Logger.hpp"
+#include "execution/evaluation_result_file.hpp"
 #include "execution/simulation_executor.hpp"
 #include "execution/simulation_types.hpp"
 #include "logs/simulation_log.hpp"
 #include "simulators/simulator_factory.hpp"
 #include "util/quick_log.hpp"
 #include <base_header.hpp>
+#include <algorithm>
+#include <charconv>
 #include <common_util.hpp>
 #include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <utility>
 namespace back_trader {
 AccountConfig get_account_config(const float start_base_balance,  // nowrap
@@ -29,6 +35,41 @@ AccountConfig get_account_config(const float start_base_balance,  // nowrap
     return config;
 }
 
+// Parse time span argument, count followed by unit d (days), w (weeks) or m (months). ex:- 90d, 1w, 6m
+bool parse_time_span(std::string_view value, EvaluationTimeSpan &time_span) {
+    if (value.size() < 2)
+        return false;
+    switch (value.back()) {
+    case 'd':
+        time_span.unit = EvaluationTimeSpan::Unit::DAY;
+        break;
+    case 'w':
+        time_span.unit = EvaluationTimeSpan::Unit::WEEK;
+        break;
+    case 'm':
+        time_span.unit = EvaluationTimeSpan::Unit::MONTH;
+        break;
+    default:
+        return false;
+    }
+    const char *count_end = value.data() + value.size() - 1;
+    const auto [ptr, error] = std::from_chars(value.data(), count_end, time_span.count);
+    return error == std::errc() && ptr == count_end && time_span.count >= 0;
+}
+
+// Parse shard argument i/n, part i (from 0) of n parts of the sweep. ex:- 0/4
+bool parse_shard(std::string_view value, SweepShard &shard) {
+    const size_t separator = value.find('/');
+    if (separator == std::string_view::npos)
+        return false;
+    const char *const index_end = value.data() + separator;
+    const char *const count_end = value.data() + value.size();
+    const auto [index_ptr, index_error] = std::from_chars(value.data(), index_end, shard.shard_index);
+    const auto [count_ptr, count_error] = std::from_chars(index_end + 1, count_end, shard.shard_count);
+    return index_error == std::errc() && index_ptr == index_end && count_error == std::errc() &&
+           count_ptr == count_end && shard.shard_index < shard.shard_count;
+}
+
 void print_account_config(AccountConfig &account_config) {
     logInfo(string_format(                                                           // nowrap
         "\n-- Current Account Configuration --",                                     // nowrap
@@ -43,11 +84,20 @@ void print_account_config(AccountConfig &account_config) {
         "\n   max_volume_ratio: ", account_config.max_volume_ratio));
 }
 
+/* History is not copied, returned view points straight into memory mapped file (which it keeps mapped) and covers only
+ * the records within [start_time, end_time). With file_history the whole file is mapped into it and returned view is
+ * the time range of it. */
 template <typename T>
-std::vector<T> read_from_binary_file(const std::string &binary_file_name, std::time_t start_time,
-                                     std::time_t end_time) {
-    std::vector<T> history = read_history_from_binary_file<T>(binary_file_name, start_time, end_time, nullptr);
-    const std::vector<T> history_subset_with_time = history_subset_copy(history, start_time, end_time);
+HistoryView<T> read_from_binary_file(const std::string &binary_file_name, std::time_t start_time, std::time_t end_time,
+                                     HistoryView<T> *file_history = nullptr) {
+    HistoryView<T> history_subset_with_time;
+    if (file_history) {
+        *file_history = read_history_view_from_binary_file<T>(binary_file_name, 0, 0);
+        const auto history_subset_it = history_subset(*file_history, start_time, end_time);
+        history_subset_with_time = file_history->subview(history_subset_it.first, history_subset_it.second);
+    } else {
+        history_subset_with_time = read_history_view_from_binary_file<T>(binary_file_name, start_time, end_time);
+    }
     Logger::get_instance()(Logger::Severity::INFO) << "Selected " << // nowrap
         history_subset_with_time.size() <<                           // nowrap
         " records within the time period: [" <<                      // nowrap
@@ -66,6 +116,14 @@ std::unique_ptr<SimulationLogger> get_logger_instance(std::string &output_simula
     return std::make_unique<SimulationLogger>(simulation_log_stream.get(), simulator_log_stream.get());
 }
 
+// Sorts best score first, equal scores keep their order (of the sweep), so merged shards rank the same.
+void sort_evaluation_results(std::vector<SimulatorEvaluationResult> &evaluation_results) {
+    std::stable_sort(evaluation_results.begin(), evaluation_results.end(),
+                     [](const SimulatorEvaluationResult &left, const SimulatorEvaluationResult &right) {
+                         return left.score > right.score;
+                     });
+}
+
 void print_combination_of_trade_evaluation_results(const std::vector<SimulatorEvaluationResult> &evaluation_results,
                                                    size_t top) {
     int it_count = std::min(evaluation_results.size(), top);
@@ -91,6 +149,8 @@ void print_trade_simulator_evaluation_result(const SimulatorEvaluationResult &si
             period.result.simulator_volatility << "  | " <<                                               // nowrap
             period.result.base_volatility << Logger::endl;
     }
+    logInfo(string_format("Score: ", sim_evaluation_result.score, " over ", sim_evaluation_result.periods.size(),
+                          " periods"));
 }
 } // namespace back_trader
 
@@ -110,6 +170,17 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    /* -------------------- Merge results of sharded sweep --------------------*/
+    if (arg_map["merge_results_files"] != "") {
+        std::vector<SimulatorEvaluationResult> sweep_results;
+        if (!read_evaluation_results_files(split_arg_list(arg_map["merge_results_files"]), sweep_results))
+            std::exit(EXIT_FAILURE);
+        logInfo(string_format("Merged results of ", sweep_results.size(), " simulators"));
+        sort_evaluation_results(sweep_results);
+        print_combination_of_trade_evaluation_results(sweep_results, TOP_N_RESULTS);
+        return 0;
+    }
+
     /* ------------------ Get command line arguments ---------------------*/
     std::time_t start_time = (arg_map["start_time"] == "" ? convert_time_string(START_TIME) // nowrap
                                                           : convert_time_string(arg_map["start_time"]));
@@ -126,16 +197,79 @@ int main(int argc, char *argv[]) {
                                        ? 0 // nowrap
                                        : std::stoi(arg_map["evaluation_period_months"]);
 
+    // Windows of evaluation_period_months starting every month, unless given as evaluation_window/evaluation_step
+    EvaluationTimeSpan evaluation_window{evaluation_period_months, EvaluationTimeSpan::Unit::MONTH};
+    EvaluationTimeSpan evaluation_step{1, EvaluationTimeSpan::Unit::MONTH};
+    if (arg_map["evaluation_window"] != "" && !parse_time_span(arg_map["evaluation_window"], evaluation_window)) {
+        logError("evaluation_window should be count of days, weeks or months (ex:- 90d, 2w, 6m)");
+        std::exit(EXIT_FAILURE);
+    }
+    if (arg_map["evaluation_step"] == "") {
+        evaluation_step.unit = evaluation_window.unit;
+    } else if (!parse_time_span(arg_map["evaluation_step"], evaluation_step) || evaluation_step.count == 0) {
+        logError("evaluation_step should be positive count of days, weeks or months (ex:- 1d, 1w, 1m)");
+        std::exit(EXIT_FAILURE);
+    }
+
     bool evaluate_combination = arg_map["evaluate_combination"] == "" ? EVALUATE_COMBINATION // nowrap
                                                                       : std::stoi(arg_map["evaluate_combination"]);
 
+    size_t successive_halving = arg_map["successive_halving"] == "" ? SUCCESSIVE_HALVING // nowrap
+                                                                    : std::stoul(arg_map["successive_halving"]);
+    if (successive_halving == 1) {
+        logError("successive_halving should be 0 (disabled) or reduction factor of every round (ex:- 2, 3)");
+        std::exit(EXIT_FAILURE);
+    }
+
+    size_t search_budget = arg_map["search_budget"] == "" ? SEARCH_BUDGET : std::stoul(arg_map["search_budget"]);
+    size_t search_batch_size =
+        arg_map["search_batch_size"] == "" ? SEARCH_BATCH_SIZE : std::stoul(arg_map["search_batch_size"]);
+    if (search_batch_size == 0) {
+        logError("search_batch_size should be positive");
+        std::exit(EXIT_FAILURE);
+    }
+    uint32_t search_seed = arg_map["search_seed"] == "" ? SEARCH_SEED : std::stoul(arg_map["search_seed"]);
+    if (search_budget && successive_halving) {
+        logError("search_budget and successive_halving can't be used together");
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Whole sweep unless it's split between processes
+    SweepShard shard{0, 1};
+    if (arg_map["shard"] != "" && !parse_shard(arg_map["shard"], shard)) {
+        logError("shard should be i/n, part i (from 0) of n parts of the sweep (ex:- 0/4)");
+        std::exit(EXIT_FAILURE);
+    }
+    if (shard.shard_count > 1 && (search_budget || successive_halving)) {
+        logError("shard can't be used with search_budget or successive_halving, they rank the whole sweep");
+        std::exit(EXIT_FAILURE);
+    }
+    std::string output_results_file = arg_map["output_results_file"];
+
+    size_t threads = arg_map["threads"] == "" ? SIMULATION_THREADS : std::stoul(arg_map["threads"]);
+    bool persist_range_index = arg_map["persist_range_index"] == "" ? PERSIST_RANGE_INDEX // nowrap
+                                                                    : std::stoi(arg_map["persist_range_index"]);
+
     std::string strategy_name = arg_map["simulator"] == "" ? "rebalancing" : arg_map["simulator"];
     std::string input_price_history_binary_file = arg_map["input_price_history_binary_file"];
     std::string output_account_log_file = arg_map["output_account_log_file"];
     std::string output_simulator_log_file = arg_map["output_simulator_log_file"];
 
     /* --------------------------- Read price history -------------------------*/
-    OhlcHistory ohlc_history = read_from_binary_file<OhlcTick>(input_price_history_binary_file, start_time, end_time);
+    // Persisted range index is of the whole history file, which is then mapped and the time range is a view into it
+    RangeIndexSource range_index_source;
+    if (persist_range_index && !get_range_index_source(input_price_history_binary_file, range_index_source)) {
+        logError(string_format("Range index can't be persisted for ", input_price_history_binary_file,
+                               ", only for history file with (uncompressed) header"));
+        persist_range_index = false;
+    }
+    OhlcHistoryView file_ohlc_history;
+    OhlcHistoryView ohlc_history = read_from_binary_file<OhlcTick>(
+        input_price_history_binary_file, start_time, end_time, persist_range_index ? &file_ohlc_history : nullptr);
+    if (ohlc_history.empty()) {
+        logError("No OHLC history to simulate on");
+        std::exit(EXIT_FAILURE);
+    }
     // TODO:- Read and handle fear and greed
 
     AccountConfig account_config =
@@ -144,44 +278,129 @@ int main(int argc, char *argv[]) {
     SimEvaluationConfig sim_evaluation_config;
     sim_evaluation_config.start_timestamp_sec = start_time;
     sim_evaluation_config.end_timestamp_sec = end_time;
-    sim_evaluation_config.evaluation_period_months = evaluation_period_months;
+    sim_evaluation_config.evaluation_window = evaluation_window;
+    sim_evaluation_config.evaluation_step = evaluation_step;
+    sim_evaluation_config.fast_execute = evaluate_combination;
 
     // Take timestamp for latency check
     const std::time_t latency_start = std::time(nullptr);
+    // Allocations per phase (counted only when built with COUNT_ALLOCATIONS)
+    const size_t setup_allocation_count = total_allocation_count();
+
+    /* Low/high range index shared by all the simulations, of the history or of the whole history file when it's
+     persisted (read from next to the history file unless the file changed) */
+    const OhlcHistoryView &indexed_ohlc_history = persist_range_index ? file_ohlc_history : ohlc_history;
+    OhlcColumns ohlc_columns;
+    OhlcRangeIndex ohlc_range_index;
+    const std::string range_index_file = input_price_history_binary_file + ".range_index";
+    if (!persist_range_index ||
+        !ohlc_range_index.read_from_file(range_index_file, range_index_source, indexed_ohlc_history)) {
+        ohlc_columns = OhlcColumns(indexed_ohlc_history);
+        ohlc_range_index = OhlcRangeIndex(indexed_ohlc_history, ohlc_columns);
+        if (persist_range_index && !ohlc_range_index.write_to_file(range_index_file, range_index_source))
+            logError(string_format("Can not write range index file ", range_index_file));
+    } else {
+        logInfo(string_format("Read range index from ", range_index_file));
+    }
+
+    // Periods (with their baselines) are computed once, shared by all the simulators
+    const EvaluationPlan evaluation_plan = get_evaluation_plan(sim_evaluation_config, ohlc_history, &ohlc_range_index);
+    logInfo(string_format("Evaluation plan of ", evaluation_plan.periods.size(), " periods"));
 
     if (evaluate_combination) {
-        sim_evaluation_config.fast_execute = true;
         logger(Logger::Severity::INFO) << "Evaluation Combination of simulators" << Logger::endl;
-        std::vector<std::unique_ptr<SimulatorDispatcher>> sim_dispatchers =
-            get_combination_of_simulators(strategy_name);
-
-        std::vector<SimulatorEvaluationResult> simulation_evaluation_result =
-            evaluate_combination_of_trade_simulators(account_config,        // nowrap
-                                                     sim_evaluation_config, // nowrap
-                                                     ohlc_history,          // nowrap
-                                                     nullptr,               // nowrap
-                                                     sim_dispatchers);
-
-        std::sort(simulation_evaluation_result.begin(), simulation_evaluation_result.end(),
-                  [](const SimulatorEvaluationResult &left, const SimulatorEvaluationResult &right) {
-                      return left.score > right.score;
-                  });
-        print_combination_of_trade_evaluation_results(simulation_evaluation_result, 30);
-    } else {
+        ThreadPool thread_pool(threads);
+        std::vector<SimulatorEvaluationResult> simulation_evaluation_result;
+        size_t sweep_size = search_budget;
+        if (search_budget) {
+            logInfo(string_format("Searching ", search_budget, " configs on ", thread_pool.size(), " threads"));
+            const ParameterSearchSpace search_space = get_parameter_search_space(strategy_name);
+            const ParameterSearchConfig search_config{search_budget, search_batch_size, SEARCH_ELITE_RATIO,
+                                                      search_seed};
+            simulation_evaluation_result = search_trade_simulator_parameters(account_config,  // nowrap
+                                                                             evaluation_plan, // nowrap
+                                                                             nullptr,         // nowrap
+                                                                             search_space,    // nowrap
+                                                                             search_config,   // nowrap
+                                                                             thread_pool);
+        } else {
+            std::vector<std::unique_ptr<SimulatorDispatcher>> sim_dispatchers =
+                get_combination_of_simulators(strategy_name);
+            sweep_size = sim_dispatchers.size();
+            if (shard.shard_count > 1) {
+                // Only simulators of the shard, the others are evaluated by the other processes
+                sim_dispatchers.erase(sim_dispatchers.begin() + shard.end(sweep_size), sim_dispatchers.end());
+                sim_dispatchers.erase(sim_dispatchers.begin(), sim_dispatchers.begin() + shard.begin(sweep_size));
+                logInfo(string_format("Shard ", shard.shard_index, "/", shard.shard_count, " of ", sweep_size,
+                                      " simulators"));
+            }
+            logInfo(string_format("Evaluating ", sim_dispatchers.size(), " simulators on ", thread_pool.size(),
+                                  " threads"));
+            simulation_evaluation_result =
+                successive_halving
+                    ? evaluate_combination_of_trade_simulators_with_halving(account_config,     // nowrap
+                                                                            evaluation_plan,    // nowrap
+                                                                            nullptr,            // nowrap
+                                                                            sim_dispatchers,    // nowrap
+                                                                            successive_halving, // nowrap
+                                                                            TOP_N_RESULTS,      // nowrap
+                                                                            thread_pool)
+                    : evaluate_combination_of_trade_simulators(account_config,  // nowrap
+                                                               evaluation_plan, // nowrap
+                                                               nullptr,         // nowrap
+                                                               sim_dispatchers, // nowrap
+                                                               thread_pool);
+        }
 
-        sim_evaluation_config.fast_execute = false;
+        // Results file of whole sweep is shard 0/1, pruned simulators of successive halving are not in it
+        if (successive_halving)
+            sweep_size = simulation_evaluation_result.size();
+        if (output_results_file != "") {
+            // Shards merged together have to be evaluated over the same inputs
+            SweepInputs sweep_inputs;
+            sweep_inputs.history_file_name = input_price_history_binary_file;
+            sweep_inputs.start_timestamp_sec = start_time;
+            sweep_inputs.end_timestamp_sec = end_time;
+            sweep_inputs.evaluation_window = evaluation_window;
+            sweep_inputs.evaluation_step = evaluation_step;
+            sweep_inputs.strategy_name = strategy_name;
+            sweep_inputs.account_config = account_config;
+            if (!read_history_file_extent<OhlcTick>(input_price_history_binary_file,
+                                                    sweep_inputs.history_record_count,
+                                                    sweep_inputs.history_last_timestamp_sec)) {
+                logError(string_format("Can not read ", input_price_history_binary_file));
+                std::exit(EXIT_FAILURE);
+            }
+            if (!write_evaluation_results_file(output_results_file, shard, sweep_size,
+                                               get_sweep_fingerprint(sweep_inputs), simulation_evaluation_result))
+                std::exit(EXIT_FAILURE);
+        }
+        sort_evaluation_results(simulation_evaluation_result);
+        print_combination_of_trade_evaluation_results(simulation_evaluation_result, TOP_N_RESULTS);
+    } else {
         std::unique_ptr<SimulatorDispatcher> sim_dispather = get_trade_simulator(strategy_name);
         logInfo(string_format(sim_dispather->get_names(), " evaluation"));
         logger(Logger::Severity::INFO) << sim_dispather->get_names() << " evaluation" << Logger::endl;
-        std::unique_ptr<std::ofstream> account_log_stream = get_log_stream(output_account_log_file);
-        std::unique_ptr<std::ofstream> simulator_log_stream = get_log_stream(output_simulator_log_file);
-        SimulationLogger logger(account_log_stream.get(), simulator_log_stream.get());
-        SimulatorEvaluationResult simulation_result = evaluate_trade_simulator(account_config,        // nowrap
-                                                                               sim_evaluation_config, // nowrap
-                                                                               ohlc_history,          // nowrap
-                                                                               nullptr,               // nowrap
-                                                                               *sim_dispather,        // nowrap
-                                                                               &logger);
+        SimulatorEvaluationResult simulation_result;
+        if (output_account_log_file == "" && output_simulator_log_file == "") {
+            // Nothing to log, evaluation windows are independent and run in parallel
+            ThreadPool thread_pool(threads);
+            simulation_result = evaluate_trade_simulator(account_config,  // nowrap
+                                                         evaluation_plan, // nowrap
+                                                         nullptr,         // nowrap
+                                                         *sim_dispather,  // nowrap
+                                                         thread_pool);
+        } else {
+            // Logs are written in order of the periods, so they are executed one by one
+            std::unique_ptr<std::ofstream> account_log_stream = get_log_stream(output_account_log_file);
+            std::unique_ptr<std::ofstream> simulator_log_stream = get_log_stream(output_simulator_log_file);
+            SimulationLogger logger(account_log_stream.get(), simulator_log_stream.get());
+            simulation_result = evaluate_trade_simulator(account_config,  // nowrap
+                                                         evaluation_plan, // nowrap
+                                                         nullptr,         // nowrap
+                                                         *sim_dispather,  // nowrap
+                                                         &logger);
+        }
         print_trade_simulator_evaluation_result(simulation_result);
     }
 
@@ -189,4 +408,7 @@ int main(int argc, char *argv[]) {
     std::time_t latency_end = std::time(nullptr);
     logger(Logger::Severity::INFO) << "Evaluated in " << duration_to_string(latency_end - latency_start) << "sec"
                                    << Logger::endl;
+    if (AllocationCountingEnabled)
+        logInfo(string_format("Heap allocations, setup: ", setup_allocation_count,
+                              " evaluation: ", total_allocation_count() - setup_allocation_count));
 }
\ No newline at end of file
@@ -33,6 +33,29 @@ std::vector<std::unique_ptr<SimulatorDispatcher>> get_combination_of_stop_trade_
         /*stop_order_decreases_per_day=*/{0.01, 0.05, 0.1});
 }
 
+ParameterSearchSpace get_rebalancing_trade_simulator_search_space() {
+    ParameterSearchSpace search_space;
+    search_space.parameter_ranges = {{"alpha", 0.05f, 0.95f}, {"epsilon", 0.005f, 0.3f}};
+    search_space.new_dispatcher = [](const std::vector<float> &parameters) {
+        RebalancingTradeSimulatorConfig config{parameters[0], parameters[1]};
+        return std::unique_ptr<SimulatorDispatcher>(new RebalancingSimulatorDispatcher(config));
+    };
+    return search_space;
+}
+
+ParameterSearchSpace get_stop_trade_simulator_search_space() {
+    ParameterSearchSpace search_space;
+    search_space.parameter_ranges = {{"stop_order_margin", 0.01f, 0.3f},
+                                     {"stop_order_move_margin", 0.01f, 0.3f},
+                                     {"stop_order_increase_per_day", 0.001f, 0.2f},
+                                     {"stop_order_decrease_per_day", 0.001f, 0.2f}};
+    search_space.new_dispatcher = [](const std::vector<float> &parameters) {
+        StopTradeSimulatorConfig config{parameters[0], parameters[1], parameters[2], parameters[3]};
+        return std::unique_ptr<SimulatorDispatcher>(new StopTradeSimulatorDispatcher(config));
+    };
+    return search_space;
+}
+
 /* Update with other strategy if get added, If name of strategy not found end it*/
 
 std::unique_ptr<SimulatorDispatcher> get_trade_simulator(std::string_view strategy_name) {
@@ -53,4 +76,14 @@ std::vector<std::unique_ptr<SimulatorDispatcher>> get_combination_of_simulators(
         std::exit(EXIT_FAILURE);
     }
 }
+
+ParameterSearchSpace get_parameter_search_space(std::string_view strategy_name) {
+    if (strategy_name == RebalancingTradeSimulatorName) {
+        return get_rebalancing_trade_simulator_search_space();
+    } else if (strategy_name == StopTradeSimulatorName) {
+        return get_stop_trade_simulator_search_space();
+    } else {
+        std::exit(EXIT_FAILURE);
+    }
+}
 } // namespace back_trader
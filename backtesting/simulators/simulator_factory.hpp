@@ -1,4 +1,5 @@
 #pragma once
+#include "../execution/parameter_search.hpp"
 #include <base_header.hpp>
 #include <memory>
 #include <string_view>
@@ -9,4 +10,7 @@ std::unique_ptr<SimulatorDispatcher> get_trade_simulator(std::string_view strate
 
 // return simulators with all combinations of default config
 std::vector<std::unique_ptr<SimulatorDispatcher>> get_combination_of_simulators(std::string_view strategy_name);
+
+// return continuous ranges of the config parameters of strategy, searched by search_trade_simulator_parameters
+ParameterSearchSpace get_parameter_search_space(std::string_view strategy_name);
 } // namespace back_trader
\ No newline at end of file
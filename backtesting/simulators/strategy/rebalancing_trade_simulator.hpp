@@ -3,17 +3,96 @@
 #include <base_header.hpp>
 
 #include <memory>
+#include <vector>
 
 namespace back_trader {
+/*
+ Rebalancing step on close price shared by RebalancingTradeSimulator::update and every lane of
+ BatchRebalancingTradeSimulator::update, so both do exactly the same arithmetic and emit bit identical orders.
+ new_order() returns the next emitted order to be filled.
+*/
+template <typename NewOrder>
+inline void emit_rebalancing_orders(float alpha, float epsilon, float base_balance, float quote_balance, float price,
+                                    NewOrder &&new_order) {
+    // whole value of this porfolio depends on the current price of base currency
+    const float current_portfolio_value = base_balance * price + quote_balance;
+
+    /*
+     *epsilon is defined as allowed deviaton from original alocation of ratio of base_currency over quote_currency
+     */
+    const float alpha_max = alpha * (1 + epsilon);
+    const float alpha_min = alpha * (1 - epsilon);
+
+    /* Beta shows how much of portfolio value are allocated into base currency. Or can say the exposure to market,
+     * (Basically how much it will affect the curren_portfolio value if price of base currency goes up or down) */
+    const float beta = base_balance * price / current_portfolio_value;
+
+    /* Base currency allocation is higher than maximum allowed allocation, Logically sell some base currency (crypto)
+     and get USD back in protfolio, and that's the rebalancing Trade.*/
+    if (beta > alpha_max) {
+        // This will reduce the allocation in crypto back to original apha level. (even removing allowed epsilon)
+        /* Example :- alpha = 0.7, portfolio_value = 100, beta = 0.9 (90 usd worth in btc and 10 in usd), epsilon = 0.1,
+         * price (btc/usd) = 10. (10% deviation allowd but right now it's more), So we sell
+         * ((1 - 0.7) * 100 - 10) /10 = 2 (BTC). That will bring current alpha or current allocation in base currency
+         * down to original 0.7 which meas alpha == beta. And do this imidiatly so apply as market order*/
+        const float sell_base_amount = ((1 - alpha) * current_portfolio_value - quote_balance) / price;
+        Order &sell_order = new_order();
+        sell_order.side = Order::Side::SELL;
+        sell_order.type = Order::Type::MARKET;
+        sell_order.amount_kind = Order::AmountKind::BASE;
+        sell_order.amount = sell_base_amount;
+    } else if (beta < alpha_min) {
+        // This will reduce quote_balance and allocate more in crypto
+        const float buy_base_amount = (quote_balance - (1 - alpha) * current_portfolio_value) / price;
+        Order &buy_order = new_order();
+        buy_order.side = Order::Side::BUY;
+        buy_order.type = Order::Type::MARKET;
+        buy_order.amount_kind = Order::AmountKind::BASE;
+        buy_order.amount = buy_base_amount;
+    } else if (base_balance > 1.0e-6f && quote_balance > 1.0e-6f) {
+        // any other case when base and quote are not zero (avoid making base or quote to zero)and our protfolio_value
+        // is not deviated, sell for profit unless alpha is 1 means allocate all in base currency
+        // Buy / Sell strategy for profit.
+        if (alpha * (1 + epsilon) < 1) {
+
+            const float sell_price = (alpha * (1 + epsilon) * quote_balance) / (1 - alpha * (1 + epsilon));
+
+            // 100.0f factor too good to be true
+            if (sell_price > price && sell_price < 100.0f * price) {
+                const float sell_base_amount = base_balance * epsilon / (1 + epsilon);
+                Order &sell_order = new_order();
+                sell_order.side = Order::Side::SELL;
+
+                // put a limit order as we are selling profit not for balancing the portfolio
+                sell_order.type = Order::Type::LIMIT;
+                sell_order.amount_kind = Order::AmountKind::BASE;
+                sell_order.amount = sell_base_amount;
+                sell_order.price = sell_price;
+            }
+        }
+
+        const float buy_price = (alpha * (1 - epsilon) * quote_balance) / (1 - alpha * (1 - epsilon));
+        if (buy_price < price && buy_price > price / 100.0f) {
+            const float buy_base_amount = base_balance * epsilon * epsilon / (1 - epsilon);
+            Order &buy_order = new_order();
+            buy_order.type = Order::Type::LIMIT;
+            buy_order.side = Order::Side::BUY;
+            buy_order.amount_kind = Order::AmountKind::BASE;
+            buy_order.amount = buy_base_amount;
+            buy_order.price = buy_price;
+        }
+    }
+}
+
 // Rebalancing keeps the base (crypto) currency value to quote value ratio constant.
-class RebalancingTradeSimulator : public TradeSimulator {
+class RebalancingTradeSimulator final : public TradeSimulator {
   public:
     explicit RebalancingTradeSimulator(const RebalancingTradeSimulatorConfig &simulator_config)
         : _sim_config(simulator_config) {}
     virtual ~RebalancingTradeSimulator() {}
     void update(const OhlcTick &ohlc_tick, const std::vector<float> &fear_and_greed_input_signals, float base_balance,
                 float quote_balance, std::vector<Order> &orders) override;
-    std::string get_internal_state() const override;
+    void write_internal_state(std::ostream &os) const override;
 
   private:
     RebalancingTradeSimulatorConfig _sim_config;
@@ -26,6 +105,25 @@ class RebalancingTradeSimulator : public TradeSimulator {
     float _last_close = 0.0f;
 };
 
+// RebalancingTradeSimulator of every configuration as a lane of single batch.
+class BatchRebalancingTradeSimulator : public BatchTradeSimulator {
+  public:
+    explicit BatchRebalancingTradeSimulator(const std::vector<RebalancingTradeSimulatorConfig> &simulator_configs);
+    virtual ~BatchRebalancingTradeSimulator() {}
+    size_t size() const override { return _alpha.size(); }
+    // Sell and buy limit orders at most.
+    size_t max_orders_per_lane() const override { return 2; }
+    void update(const OhlcTick &ohlc_tick, const float *base_balances, const float *quote_balances,
+                BatchOrders &orders) override;
+
+  private:
+    // Configuration of the lanes.
+    AlignedVector<float> _alpha;
+    AlignedVector<float> _epsilon;
+    // Last seen UNIX timestamp (in seconds), same for all lanes.
+    int64_t _last_timestamp_sec = 0;
+};
+
 // helper class of Rrebalancing simulator to get different instance of same simulator
 class RebalancingSimulatorDispatcher : public SimulatorDispatcher {
   public:
@@ -34,6 +132,13 @@ class RebalancingSimulatorDispatcher : public SimulatorDispatcher {
     virtual ~RebalancingSimulatorDispatcher() {}
     std::string get_names() const override;
     std::unique_ptr<TradeSimulator> new_simulator() const override;
+    SimulationResult execute_simulation(const AccountConfig &account_config,       // nowrap
+                                        const EvaluationPeriod &evaluation_period, // nowrap
+                                        const FearAndGreed *fear_and_greed_input,  // nowrap
+                                        bool fast_execute,                         // nowrap
+                                        SimulationLogger *logger) const override;
+    std::unique_ptr<BatchTradeSimulator>
+    new_batch_simulator(const std::vector<const SimulatorDispatcher *> &simulator_dispatchers) const override;
 
     // Take list of alphas and epsilons and return simulaterdispatcher with all combinations of alphas and epsilons
     static std::vector<std::unique_ptr<SimulatorDispatcher>>
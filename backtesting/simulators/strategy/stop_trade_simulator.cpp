@@ -1,11 +1,15 @@
 #include "stop_trade_simulator.hpp"
+#include "../../execution/simulation_executor.hpp"
 #include "common_interface/common.hpp"
 #include "common_util/string_format_util.hpp"
 #include "price_history/history_subset.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <common_util.hpp>
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 using namespace common_util;
 namespace back_trader {
@@ -21,73 +25,109 @@ void StopTradeSimulator::update(const OhlcTick &ohlc_tick, const std::vector<flo
     // Do not trade simulate for account balance == 0
     assert(base_balance > 0 || quote_balance > 0);
     // if most of the currency are in crypto it's Long or otherwise. Get current account mode
-    const Mode current_mode = (base_balance * price >= quote_balance) ? Mode::LONG : Mode::CASH;
-    // current ohlc shouldn't be coming more than 1 hour intervals or mode has been changed
-    if (timestamp_sec >= timestamp_sec + _max_allowed_gap_sec || current_mode != _mode) {
-        if (current_mode == Mode::LONG) {
-            _stop_order_price = (1 - _sim_config.stop_order_margin) * price;
-        } else {
-            assert(current_mode == Mode::CASH);
-            _stop_order_price = (1 + _sim_config.stop_order_margin) * price;
-        }
-    } else {
-        // If last last executed mode was same as current ohlc just update the price
-        assert(current_mode == _mode);
-        update_stop_order_price(current_mode, timestamp_sec, price);
+    const Mode current_mode = is_stop_long_mode(base_balance, quote_balance, price) ? Mode::LONG : Mode::CASH;
+    // Per tick moves of stop order price change only with the interval between the ticks
+    const float ticks_per_day = get_stop_ticks_per_day(timestamp_sec, _last_timestamp_sec);
+    if (ticks_per_day != _ticks_per_day) {
+        _ticks_per_day = ticks_per_day;
+        _stop_order_increase_per_tick =
+            get_stop_order_increase_per_tick(_sim_config.stop_order_increase_per_day, ticks_per_day);
+        _stop_order_decrease_per_tick =
+            get_stop_order_decrease_per_tick(_sim_config.stop_order_decrease_per_day, ticks_per_day);
     }
+    // current ohlc shouldn't be coming more than 1 hour intervals or mode has been changed
+    const bool mode_changed = timestamp_sec >= timestamp_sec + _max_allowed_gap_sec || current_mode != _mode;
+    _stop_order_price =
+        get_next_stop_order_price(current_mode == Mode::LONG, mode_changed, _stop_order_price, price, _sim_config,
+                                  _stop_order_increase_per_tick, _stop_order_decrease_per_tick);
     _last_timestamp_sec = timestamp_sec;
     _last_quote_balance = quote_balance;
     _last_base_balance = base_balance;
     _last_close = price;
     _mode = current_mode;
-    emit_stop_order(price, orders);
+    orders.emplace_back();
+    set_stop_order(_mode == Mode::LONG, _last_base_balance, _last_quote_balance, _stop_order_price, orders.back());
+}
+
+bool StopTradeSimulator::can_skip(const OhlcRange &ohlc_range) const {
+    return _mode != Mode::NONE && can_skip_stop_ticks(_mode == Mode::LONG, _last_base_balance, _last_quote_balance,
+                                                      _stop_order_price, _sim_config.stop_order_move_margin,
+                                                      ohlc_range);
+}
+
+void StopTradeSimulator::skip(const OhlcTick &last_tick) {
+    _last_timestamp_sec = last_tick.timestamp_sec;
+    _last_close = last_tick.close;
 }
 
-void StopTradeSimulator::update_stop_order_price(Mode mode, int64_t timestamp_sec, float price) {
-    const float current_interval_rate_sec = std::min(SecondsPerDay, timestamp_sec - _last_timestamp_sec);
-    const float ticks_per_day = SecondsPerDay / current_interval_rate_sec;
-    if (mode == Mode::LONG) {
-        const float stop_order_increase_threshold = (1 - _sim_config.stop_order_move_margin) * price;
-        if (_stop_order_price <= stop_order_increase_threshold) {
-            const float stop_order_increase_per_tick =
-                std::exp(std::log(1 + _sim_config.stop_order_increase_per_day) / ticks_per_day) - 1;
-            _stop_order_price =
-                std::max(_stop_order_price, std::min(stop_order_increase_threshold,
-                                                     (1 + stop_order_increase_per_tick) * _stop_order_price));
-        }
-    } else {
-        assert(mode == Mode::CASH);
-        const float stop_order_decrease_threshold = (1 + _sim_config.stop_order_move_margin) * price;
-        if (_stop_order_price >= stop_order_decrease_threshold) {
-            const float stop_order_decrease_per_tick =
-                1 - std::exp(std::log(1 - _sim_config.stop_order_decrease_per_day) / ticks_per_day);
-            _stop_order_price =
-                std::min(_stop_order_price, std::max(stop_order_decrease_threshold,
-                                                     (1 - stop_order_decrease_per_tick) * _stop_order_price));
-        }
+void StopTradeSimulator::write_internal_state(std::ostream &os) const {
+    os << _last_timestamp_sec << ',' << _last_base_balance << ',' << _last_quote_balance << ',' << _last_close << ','
+       << (_mode == Mode::LONG ? "LONG" : "CASH") << _stop_order_price;
+}
+
+BatchStopTradeSimulator::BatchStopTradeSimulator(const std::vector<StopTradeSimulatorConfig> &configs)
+    : _configs(configs), _stop_order_increase_per_tick(configs.size()), _stop_order_decrease_per_tick(configs.size()),
+      _mode(configs.size(), NONE), _current_mode(configs.size()), _stop_order_price(configs.size(), 0.0f),
+      _last_base_balance(configs.size(), 0.0f), _last_quote_balance(configs.size(), 0.0f) {}
+
+void BatchStopTradeSimulator::update_ticks_per_day(float ticks_per_day) {
+    _ticks_per_day = ticks_per_day;
+    for (size_t i = 0; i < size(); ++i) {
+        _stop_order_increase_per_tick[i] =
+            get_stop_order_increase_per_tick(_configs[i].stop_order_increase_per_day, ticks_per_day);
+        _stop_order_decrease_per_tick[i] =
+            get_stop_order_decrease_per_tick(_configs[i].stop_order_decrease_per_day, ticks_per_day);
     }
 }
 
-void StopTradeSimulator::emit_stop_order(float price, std::vector<Order> &orders) const {
-    orders.emplace_back();
-    Order &order = orders.back();
-    order.type = Order::Type::STOP;
-    if (_mode == Mode::LONG) {
-        order.side = Order::Side::SELL;
-        order.amount = Order::BaseAmount{_last_base_balance};
-    } else {
-        assert(_mode == Mode::CASH);
-        order.side = Order::Side::BUY;
-        order.amount = Order::QuoteAmount{_last_quote_balance};
+/*
+ Every lane runs the same steps as StopTradeSimulator::update, so the orders are bit identical. Per tick stop order
+ moves depend only on the interval between the ticks, which is the same for every lane, so they are computed once per
+ interval for all the lanes.
+*/
+void BatchStopTradeSimulator::update(const OhlcTick &ohlc_tick, const float *base_balances,
+                                     const float *quote_balances, BatchOrders &orders) {
+    const int64_t timestamp_sec = ohlc_tick.timestamp_sec;
+    const float price = ohlc_tick.close;
+    assert(timestamp_sec > _last_timestamp_sec);
+    assert(price > 0);
+    const size_t lane_count = size();
+    uint8_t *current_mode = _current_mode.data();
+
+    // Branch free pass over all the lanes (vectorized)
+    for (size_t i = 0; i < lane_count; ++i)
+        current_mode[i] = is_stop_long_mode(base_balances[i], quote_balances[i], price) ? LONG : CASH;
+
+    const float ticks_per_day = get_stop_ticks_per_day(timestamp_sec, _last_timestamp_sec);
+    if (ticks_per_day != _ticks_per_day)
+        update_ticks_per_day(ticks_per_day);
+    for (size_t i = 0; i < lane_count; ++i) {
+        assert(base_balances[i] > 0 || quote_balances[i] > 0);
+        const bool long_mode = current_mode[i] == LONG;
+        _stop_order_price[i] =
+            get_next_stop_order_price(long_mode, current_mode[i] != _mode[i], _stop_order_price[i], price, _configs[i],
+                                      _stop_order_increase_per_tick[i], _stop_order_decrease_per_tick[i]);
+        _mode[i] = current_mode[i];
+        _last_base_balance[i] = base_balances[i];
+        _last_quote_balance[i] = quote_balances[i];
+        set_stop_order(long_mode, base_balances[i], quote_balances[i], _stop_order_price[i], orders.emplace_back(i));
     }
-    order.price = _stop_order_price;
+    _last_timestamp_sec = timestamp_sec;
 }
 
-std::string StopTradeSimulator::get_internal_state() const {
-    return string_format(_last_timestamp_sec, ',', _last_base_balance, ',', _last_quote_balance, ',', _last_close, ',',
-                         _mode == Mode::LONG ? "LONG" : "CASH", _stop_order_price);
+// Ticks are skipped only when no lane would do anything on them, lanes don't skip alone.
+bool BatchStopTradeSimulator::can_skip(const OhlcRange &ohlc_range) const {
+    for (size_t i = 0; i < size(); ++i) {
+        if (_mode[i] == NONE || !can_skip_stop_ticks(_mode[i] == LONG, _last_base_balance[i], _last_quote_balance[i],
+                                                     _stop_order_price[i], _configs[i].stop_order_move_margin,
+                                                     ohlc_range))
+            return false;
+    }
+    return true;
 }
 
+void BatchStopTradeSimulator::skip(const OhlcTick &last_tick) { _last_timestamp_sec = last_tick.timestamp_sec; }
+
 std::string StopTradeSimulatorDispatcher::get_names() const {
     return string_format("stop_trade_simulator[", _sim_config.stop_order_margin, '|',
                          _sim_config.stop_order_move_margin, '|', _sim_config.stop_order_increase_per_day, '|',
@@ -98,6 +138,29 @@ std::unique_ptr<TradeSimulator> StopTradeSimulatorDispatcher::new_simulator() co
     return std::make_unique<StopTradeSimulator>(_sim_config);
 }
 
+SimulationResult StopTradeSimulatorDispatcher::execute_simulation(const AccountConfig &account_config,       // nowrap
+                                                                  const EvaluationPeriod &evaluation_period, // nowrap
+                                                                  const FearAndGreed *fear_and_greed_input,  // nowrap
+                                                                  bool fast_execute,                         // nowrap
+                                                                  SimulationLogger *logger) const {
+    StopTradeSimulator trade_simulator(_sim_config);
+    return execute_trade_simulation(account_config, evaluation_period, fear_and_greed_input, fast_execute,
+                                    trade_simulator, logger);
+}
+
+std::unique_ptr<BatchTradeSimulator> StopTradeSimulatorDispatcher::new_batch_simulator(
+    const std::vector<const SimulatorDispatcher *> &simulator_dispatchers) const {
+    std::vector<StopTradeSimulatorConfig> configs;
+    configs.reserve(simulator_dispatchers.size());
+    for (const SimulatorDispatcher *simulator_dispatcher : simulator_dispatchers) {
+        const auto *stop_dispatcher = dynamic_cast<const StopTradeSimulatorDispatcher *>(simulator_dispatcher);
+        if (!stop_dispatcher)
+            return nullptr;
+        configs.push_back(stop_dispatcher->_sim_config);
+    }
+    return std::make_unique<BatchStopTradeSimulator>(configs);
+}
+
 // get simulator with all combination of parameters
 std::vector<std::unique_ptr<SimulatorDispatcher>> StopTradeSimulatorDispatcher::get_combination_of_simulator(
     const std::vector<float> &stop_order_margins, const std::vector<float> &stop_order_move_margins,
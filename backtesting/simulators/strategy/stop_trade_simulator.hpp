@@ -1,14 +1,103 @@
 #pragma once
 #include "common_strategy_config.hpp"
+#include <algorithm>
 #include <base_header.hpp>
+#include <cmath>
+#include <cstdint>
+#include <vector>
 namespace back_trader {
-class StopTradeSimulator : public TradeSimulator {
+/*
+ Steps of the stop strategy shared by StopTradeSimulator::update and every lane of BatchStopTradeSimulator::update, so
+ both do exactly the same arithmetic and emit bit identical orders.
+*/
+
+// Account is LONG (holding most of its assets in the base currency) at close price, CASH otherwise.
+inline bool is_stop_long_mode(float base_balance, float quote_balance, float price) {
+    return base_balance * price >= quote_balance;
+}
+
+// Number of ticks per day for interval between the last two ticks (at most a day).
+inline float get_stop_ticks_per_day(int64_t timestamp_sec, int64_t last_timestamp_sec) {
+    const float current_interval_rate_sec = std::min(SecondsPerDay, timestamp_sec - last_timestamp_sec);
+    return SecondsPerDay / current_interval_rate_sec;
+}
+
+// Relative stop order price increase (LONG) and decrease (CASH) per tick of the per day ones.
+inline float get_stop_order_increase_per_tick(float stop_order_increase_per_day, float ticks_per_day) {
+    return std::exp(std::log(1 + stop_order_increase_per_day) / ticks_per_day) - 1;
+}
+inline float get_stop_order_decrease_per_tick(float stop_order_decrease_per_day, float ticks_per_day) {
+    return 1 - std::exp(std::log(1 - stop_order_decrease_per_day) / ticks_per_day);
+}
+
+/*
+ Stop order price after update on close price. It's set at stop_order_margin from the price when the mode changed,
+ otherwise it follows the price (by at most the per tick increase or decrease) once it's further than move margin.
+*/
+inline float get_next_stop_order_price(bool long_mode, bool mode_changed, float stop_order_price, float price,
+                                       const StopTradeSimulatorConfig &config, float stop_order_increase_per_tick,
+                                       float stop_order_decrease_per_tick) {
+    if (mode_changed)
+        return long_mode ? (1 - config.stop_order_margin) * price : (1 + config.stop_order_margin) * price;
+    if (long_mode) {
+        const float stop_order_increase_threshold = (1 - config.stop_order_move_margin) * price;
+        if (stop_order_price <= stop_order_increase_threshold) {
+            stop_order_price = std::max(
+                stop_order_price,
+                std::min(stop_order_increase_threshold, (1 + stop_order_increase_per_tick) * stop_order_price));
+        }
+    } else {
+        const float stop_order_decrease_threshold = (1 + config.stop_order_move_margin) * price;
+        if (stop_order_price >= stop_order_decrease_threshold) {
+            stop_order_price = std::min(
+                stop_order_price,
+                std::max(stop_order_decrease_threshold, (1 - stop_order_decrease_per_tick) * stop_order_price));
+        }
+    }
+    return stop_order_price;
+}
+
+// Stop sell of the whole base balance (LONG) or stop buy for the whole quote balance (CASH).
+inline void set_stop_order(bool long_mode, float base_balance, float quote_balance, float stop_order_price,
+                           Order &order) {
+    order.type = Order::Type::STOP;
+    if (long_mode) {
+        order.side = Order::Side::SELL;
+        order.amount_kind = Order::AmountKind::BASE;
+        order.amount = base_balance;
+    } else {
+        order.side = Order::Side::BUY;
+        order.amount_kind = Order::AmountKind::QUOTE;
+        order.amount = quote_balance;
+    }
+    order.price = stop_order_price;
+}
+
+/*
+ Stop order isn't triggered, mode stays the same (balances don't change without fill) and the stop order price isn't
+ moved as long as close prices (within low and high of valid OHLC ticks) don't get over (LONG) or under (CASH) the move
+ margin of the stop order price. Float multiplication is monotone, so checking the extremes is the same as checking
+ every tick.
+*/
+inline bool can_skip_stop_ticks(bool long_mode, float base_balance, float quote_balance, float stop_order_price,
+                                float stop_order_move_margin, const OhlcRange &ohlc_range) {
+    if (long_mode) {
+        return ohlc_range.low > stop_order_price && base_balance * ohlc_range.low >= quote_balance &&
+               stop_order_price > (1 - stop_order_move_margin) * ohlc_range.high;
+    }
+    return ohlc_range.high < stop_order_price && base_balance * ohlc_range.high < quote_balance &&
+           stop_order_price < (1 + stop_order_move_margin) * ohlc_range.low;
+}
+
+class StopTradeSimulator final : public TradeSimulator {
   public:
     explicit StopTradeSimulator(const StopTradeSimulatorConfig &config) : _sim_config(config) {}
     virtual ~StopTradeSimulator() {}
     void update(const OhlcTick &ohlc_tick, const std::vector<float> &fear_and_greed_input_signals, float base_balance,
                 float quote_balance, std::vector<Order> &orders) override;
-    std::string get_internal_state() const override;
+    void write_internal_state(std::ostream &os) const override;
+    bool can_skip(const OhlcRange &ohlc_range) const override;
+    void skip(const OhlcTick &last_tick) override;
 
   private:
     enum class Mode {
@@ -30,11 +119,46 @@ class StopTradeSimulator : public TradeSimulator {
     float _stop_order_price = 0;
 
     int _max_allowed_gap_sec = 1 * 60 * 60;
+    // Per tick increase (decrease) of stop order price for _ticks_per_day.
+    float _ticks_per_day = 0.0f;
+    float _stop_order_increase_per_tick = 0.0f;
+    float _stop_order_decrease_per_tick = 0.0f;
+};
+
+// StopTradeSimulator of every configuration as a lane of single batch.
+class BatchStopTradeSimulator : public BatchTradeSimulator {
+  public:
+    explicit BatchStopTradeSimulator(const std::vector<StopTradeSimulatorConfig> &configs);
+    virtual ~BatchStopTradeSimulator() {}
+    size_t size() const override { return _configs.size(); }
+    // Single stop order.
+    size_t max_orders_per_lane() const override { return 1; }
+    void update(const OhlcTick &ohlc_tick, const float *base_balances, const float *quote_balances,
+                BatchOrders &orders) override;
+    bool can_skip(const OhlcRange &ohlc_range) const override;
+    void skip(const OhlcTick &last_tick) override;
 
-    // Update price of stop order for this simulator
-    void update_stop_order_price(Mode mode, int64_t timestamp_sec, float price);
+  private:
+    // Same modes as StopTradeSimulator::Mode.
+    enum Mode : uint8_t { NONE, LONG, CASH };
+    // Configuration of the lanes.
+    std::vector<StopTradeSimulatorConfig> _configs;
+    // Per tick increase (decrease) of stop order price of the lanes for _ticks_per_day.
+    AlignedVector<float> _stop_order_increase_per_tick;
+    AlignedVector<float> _stop_order_decrease_per_tick;
+    float _ticks_per_day = 0.0f;
+    // State of the lanes.
+    AlignedVector<uint8_t> _mode;
+    AlignedVector<uint8_t> _current_mode;
+    AlignedVector<float> _stop_order_price;
+    // Last seen account balances of the lanes.
+    AlignedVector<float> _last_base_balance;
+    AlignedVector<float> _last_quote_balance;
+    // Last seen UNIX timestamp (in seconds), same for all lanes.
+    int64_t _last_timestamp_sec = 0;
 
-    void emit_stop_order(float price, std::vector<Order> &orders) const;
+    // Recomputes per tick stop order price moves when interval between the ticks changes.
+    void update_ticks_per_day(float ticks_per_day);
 };
 
 class StopTradeSimulatorDispatcher : public SimulatorDispatcher {
@@ -45,6 +169,13 @@ class StopTradeSimulatorDispatcher : public SimulatorDispatcher {
 
     std::string get_names() const override;
     std::unique_ptr<TradeSimulator> new_simulator() const override;
+    SimulationResult execute_simulation(const AccountConfig &account_config,       // nowrap
+                                        const EvaluationPeriod &evaluation_period, // nowrap
+                                        const FearAndGreed *fear_and_greed_input,  // nowrap
+                                        bool fast_execute,                         // nowrap
+                                        SimulationLogger *logger) const override;
+    std::unique_ptr<BatchTradeSimulator>
+    new_batch_simulator(const std::vector<const SimulatorDispatcher *> &simulator_dispatchers) const override;
 
     static std::vector<std::unique_ptr<SimulatorDispatcher>> get_combination_of_simulator(
         const std::vector<float> &stop_order_margins, const std::vector<float> &stop_order_move_margins,
@@ -1,72 +1,153 @@
 #include "common_util/Logger.hpp"
 #include "util/quick_log.hpp"
+#include <algorithm>
 #include <base_header.hpp>
 #include <cassert>
+#include <charconv>
 #include <common_util.hpp>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <ctime>
+#include <fstream>
+#include <future>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <unordered_map>
 using namespace common_util;
 using namespace back_trader;
 
 namespace back_trader {
 
-PriceHistory read_price_history_from_csv_file(const std::string &file_name, const std::time_t start_time,
-                                              const std::time_t end_time) {
-    const std::time_t latency_start_time = std::time(nullptr);
-    Logger &logger = Logger::get_instance();
-    logger(Logger::Severity::INFO) << "Reading price from csv file:- " << file_name << Logger::endl;
-
-    // Memory map the file as string_view
-    common_util::RMemoryMapped<char> read_file(file_name);
-    const char *begin = read_file.begin();
-    size_t view_size = read_file.size();
-    std::string_view input_file_view = std::string_view(begin, view_size);
-
-    // have a lambda to find location of next new line
-    auto new_line_position = [&](uint64_t start_pos) {
-        uint64_t found = input_file_view.find('\n', start_pos);
-        return found;
+/* Where parsing of a csv chunk started and stopped, rows are numbered from 1 within the chunk. Errors are logged when
+ chunks are merged (with line number in the file), only for the chunk where a single pass read would have stopped. */
+struct CsvChunkResult {
+    // False when parsing stopped before the end of chunk (invalid row or end_time reached).
+    bool completed = true;
+    // Row of the first parsed record, it has to be in order with the last record of the previous chunk.
+    size_t first_record_row = 0;
+    // Invalid row which stopped parsing and why, error is empty when end_time was reached.
+    size_t error_row = 0;
+    std::string error;
+
+    bool stop(size_t row, std::string error_message) {
+        completed = false;
+        error_row = row;
+        error = std::move(error_message);
+        return false;
+    }
+};
+
+/* Parse csv chunks on thread_count worker threads with parse_chunk(chunk, history, result) and concatenate the parsed
+ chunks in file order. When parse_chunk stopped before the end of its chunk (invalid row or end_time reached),
+ follow-up chunks are dropped same as a single pass read would have stopped there. */
+template <typename T, typename ChunkParser>
+std::vector<T> read_csv_history_in_chunks(std::string_view input_file_view, size_t thread_count,
+                                          ChunkParser parse_chunk) {
+    const std::vector<std::string_view> chunks = split_csv_into_chunks(input_file_view, thread_count);
+    std::vector<std::vector<T>> chunk_histories(chunks.size());
+    std::vector<CsvChunkResult> chunk_results(chunks.size());
+    std::vector<std::future<void>> chunk_futures;
+    chunk_futures.reserve(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        chunk_futures.emplace_back(std::async(std::launch::async, [&, i]() {
+            parse_chunk(chunks[i], chunk_histories[i], chunk_results[i]);
+        }));
+    }
+    size_t total_record = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        chunk_futures[i].get();
+        total_record += chunk_histories[i].size();
+    }
+    // Line in the file of the row of chunk, lines before the chunk are counted only to report an error
+    const auto get_file_line = [&](size_t chunk_index, size_t row) {
+        return static_cast<size_t>(std::count(input_file_view.data(), chunks[chunk_index].data(), '\n')) + row;
     };
 
-    PriceHistory price_history;
-    // Creat TVP object and push it to PriceHistory
+    // Reserved once for all the chunks, every chunk (the first one too) is copied into it
+    std::vector<T> history;
+    history.reserve(total_record);
+    for (size_t i = 0; i < chunk_histories.size(); ++i) {
+        std::vector<T> &chunk_history = chunk_histories[i];
+        const CsvChunkResult &chunk_result = chunk_results[i];
+        // every chunk is sorted on its own, only the seam between two chunks is left to check
+        if (!history.empty() && !chunk_history.empty() &&
+            chunk_history.front().timestamp_sec < history.back().timestamp_sec) {
+            logError(string_format("Invalid timestamp on line ", get_file_line(i, chunk_result.first_record_row), " ",
+                                   chunk_history.front().timestamp_sec, " < ", history.back().timestamp_sec));
+            break;
+        }
+        history.insert(history.end(), chunk_history.begin(), chunk_history.end());
+        // release the chunk as soon as it's merged to keep peak memory low
+        std::vector<T>().swap(chunk_history);
+        if (!chunk_result.completed) {
+            if (!chunk_result.error.empty())
+                logError(string_format(chunk_result.error, " on line ", get_file_line(i, chunk_result.error_row)));
+            break;
+        }
+    }
+    return history;
+}
+
+/* Parse price records of a single csv chunk within the time range. Returns false if it stopped before the end of chunk
+ * (invalid row or end_time reached) */
+bool parse_price_history_csv_chunk(std::string_view chunk, const std::time_t start_time, const std::time_t end_time,
+                                   PriceHistory &price_history, CsvChunkResult &result) {
+    price_history.reserve(estimate_csv_row_count(chunk));
+    int64_t time_prev = 0;
+    // Creat TVP object and push it to PriceHistory, fields are parsed in place from the mapped file
     int64_t time;
     float price;
     float volume;
-    uint64_t start = 0;
-    uint64_t found = view_size;
-    while (start < view_size) {
-        std::string temp_hold;
-        found = input_file_view.find(',', start);
-        temp_hold = input_file_view.substr(start, found - start);
-        time = std::stoul(temp_hold);
+    CsvRowReader row_reader(chunk);
+    std::string_view row;
+    while (row_reader.next_row(row)) {
+        // Only timestamp is needed to decide if row is in the time range
+        const std::from_chars_result time_result = std::from_chars(row.data(), row.data() + row.size(), time);
+        if (time_result.ec != std::errc()) {
+            return result.stop(row_reader.row_number(), "Invalid timestamp " + std::string(row));
+        }
         // skip the line if time is not valid with start time
         if (start_time > 0 && time < start_time) {
-            start = new_line_position(start) + 1;
             continue;
         }
         // have reached to the limit of end time
         if (end_time > 0 && time > end_time) {
-            break;
+            return result.stop(row_reader.row_number(), "");
         }
-        start = found + 1;
-
-        found = input_file_view.find(',', start);
-        temp_hold = input_file_view.substr(start, found - start);
-        start = found + 1;
-        price = std::stof(temp_hold.data());
-
-        found = new_line_position(start);
-        temp_hold = input_file_view.substr(start, found - start);
-        start = found + 1;
-        volume = std::stof(temp_hold.data());
+        if (time <= 0 || time < time_prev) {
+            return result.stop(row_reader.row_number(), "Invalid timestamp " + std::string(row));
+        }
+        if (!parse_csv_row(row, time, price, volume)) {
+            return result.stop(row_reader.row_number(), "Invalid price record " + std::string(row));
+        }
+        if (price_history.empty())
+            result.first_record_row = row_reader.row_number();
+        time_prev = time;
         price_history.push_back({time, price, volume});
     }
+    return true;
+}
+
+PriceHistory read_price_history_from_csv_file(const std::string &file_name, const std::time_t start_time,
+                                              const std::time_t end_time, const size_t thread_count) {
+    const std::time_t latency_start_time = std::time(nullptr);
+    Logger &logger = Logger::get_instance();
+    logger(Logger::Severity::INFO) << "Reading price from csv file:- " << file_name << " with " << thread_count
+                                   << " threads" << Logger::endl;
+
+    // Memory map the file as string_view
+    common_util::RMemoryMapped<char> read_file(file_name);
+    const char *begin = read_file.begin();
+    size_t view_size = read_file.size();
+    std::string_view input_file_view = std::string_view(begin, view_size);
+
+    PriceHistory price_history = read_csv_history_in_chunks<PriceRecord>(
+        input_file_view, thread_count,
+        [&](std::string_view chunk, PriceHistory &chunk_price_history, CsvChunkResult &chunk_result) {
+            return parse_price_history_csv_chunk(chunk, start_time, end_time, chunk_price_history, chunk_result);
+        });
     const std::time_t latency_end_time = std::time(nullptr);
     const size_t total_record = price_history.size();
     logger(Logger::Severity::INFO) << "Loaded " << total_record << " records in "               // nowrap
@@ -77,31 +158,14 @@ PriceHistory read_price_history_from_csv_file(const std::string &file_name, cons
 
 PriceHistory read_price_histry_from_binary_file(const std::string &file_name, const std::time_t start_time,
                                                 const std::time_t end_time) {
-    return read_history_from_binary_file<PriceRecord>(file_name, start_time, end_time, [](const PriceRecord &record) {
-        if (record.price <= 0) {
-            logError("Invalid Price");
-            return false;
-        }
-        if (record.volume < 0) {
-            logError("Invalid volume");
-            return false;
-        }
-        return true;
-    });
+    return read_history_from_binary_file<PriceRecord>(file_name, start_time, end_time, find_invalid_price_records);
 }
 
-// Read OHLC input file from csv
-OhlcHistory read_ohlc_history_from_csv_file(const std::string &file_name, const std::time_t start_time,
-                                            const std::time_t end_time) {
-    const std::time_t latency_start_time = std::time(nullptr);
-    Logger &logger = Logger::get_instance();
-    logger(Logger::Severity::INFO) << "Reading OHLC history from:- " << file_name << Logger::endl;
-    common_util::RMemoryMapped<char> read_file(file_name);
-    const char *begin = read_file.begin();
-    size_t view_size = read_file.size();
-    std::string_view input_file_view = std::string_view(begin, view_size);
-
-    uint64_t row = 0;
+/* Parse OHLC ticks of a single csv chunk within the time range. Returns false if it stopped before the end of chunk
+ * (invalid row or end_time reached) */
+bool parse_ohlc_history_csv_chunk(std::string_view chunk, const std::time_t start_time, const std::time_t end_time,
+                                  OhlcHistory &ohlc_history, CsvChunkResult &result) {
+    ohlc_history.reserve(estimate_csv_row_count(chunk));
     int64_t timestamp_sec_prev = 0;
 
     // ohlc
@@ -111,65 +175,62 @@ OhlcHistory read_ohlc_history_from_csv_file(const std::string &file_name, const
     float low = 0;
     float close = 0;
     float volume = 0;
-    OhlcHistory ohlc_history;
-
-    uint64_t start = 0;
-    uint64_t found = view_size;
-
-    // have a lambda to find location of next new line
-    auto new_line_pos = [&](uint64_t &start_pos) { return input_file_view.find('\n', start_pos); };
-    auto new_comma_pos = [&](uint64_t &start_pos) { return input_file_view.find(',', start_pos); };
-    auto next_comma_value = [&](uint64_t &start_pos, uint64_t &found_pos) {
-        found_pos = new_comma_pos(start_pos);
-        std::string temp_hold(input_file_view.substr(start_pos, found_pos));
-        start_pos = found_pos + 1;
-        return std::stof(temp_hold);
-    };
-    auto last_comma_value = [&](uint64_t &start_pos, uint64_t &found_pos) {
-        found_pos = new_line_pos(start_pos);
-        std::string temp_hold(input_file_view.substr(start_pos, found_pos));
-        start_pos = found_pos + 1;
-        return std::stof(temp_hold);
-    };
-
-    while (start < view_size) {
-        std::string temp_hold;
 
-        found = new_comma_pos(start);
-        temp_hold = input_file_view.substr(start, found);
-        timestamp_sec = std::stol(temp_hold);
+    CsvRowReader row_reader(chunk);
+    std::string_view row;
+    while (row_reader.next_row(row)) {
+        const std::from_chars_result timestamp_result =
+            std::from_chars(row.data(), row.data() + row.size(), timestamp_sec);
+        if (timestamp_result.ec != std::errc()) {
+            return result.stop(row_reader.row_number(), "Invalid timestamp " + std::string(row));
+        }
         // Validate timestamp
-        if (start > 0 && timestamp_sec < start_time) {
-            start = new_line_pos(start) + 1;
+        if (start_time > 0 && timestamp_sec < start_time) {
             continue;
         }
         if (end_time > 0 && timestamp_sec > end_time) {
-            break;
+            return result.stop(row_reader.row_number(), "");
         }
         if (timestamp_sec <= 0 || timestamp_sec < timestamp_sec_prev) {
-            logError("Invalid timestamp on line " + std::to_string(row));
-            break;
+            return result.stop(row_reader.row_number(), "Invalid timestamp " + std::string(row));
         }
-        start = found + 1;
 
-        open = next_comma_value(start, found);
-        high = next_comma_value(start, found);
-        low = next_comma_value(start, found);
-        close = next_comma_value(start, found);
-        volume = last_comma_value(start, found);
+        if (!parse_csv_row(row, timestamp_sec, open, high, low, close, volume)) {
+            return result.stop(row_reader.row_number(), "Invalid OHLC record " + std::string(row));
+        }
 
         if (open <= 0 || high <= 0 || low <= 0 || close <= 0 || low > open || low > high || low > close ||
             high < open || high < close) {
-            logError("Invalid OHLC prices on line " + std::to_string(row));
-            break;
+            return result.stop(row_reader.row_number(), "Invalid OHLC prices " + std::string(row));
         }
         if (volume < 0) {
-            logError("Invalid volume on the line" + std::to_string(row));
-            break;
+            return result.stop(row_reader.row_number(), "Invalid volume " + std::string(row));
         }
+        if (ohlc_history.empty())
+            result.first_record_row = row_reader.row_number();
         timestamp_sec_prev = timestamp_sec;
         ohlc_history.push_back({timestamp_sec, open, high, low, close, volume});
     }
+    return true;
+}
+
+// Read OHLC input file from csv
+OhlcHistory read_ohlc_history_from_csv_file(const std::string &file_name, const std::time_t start_time,
+                                            const std::time_t end_time, const size_t thread_count) {
+    const std::time_t latency_start_time = std::time(nullptr);
+    Logger &logger = Logger::get_instance();
+    logger(Logger::Severity::INFO) << "Reading OHLC history from:- " << file_name << " with " << thread_count
+                                   << " threads" << Logger::endl;
+    common_util::RMemoryMapped<char> read_file(file_name);
+    const char *begin = read_file.begin();
+    size_t view_size = read_file.size();
+    std::string_view input_file_view = std::string_view(begin, view_size);
+
+    OhlcHistory ohlc_history = read_csv_history_in_chunks<OhlcTick>(
+        input_file_view, thread_count,
+        [&](std::string_view chunk, OhlcHistory &chunk_ohlc_history, CsvChunkResult &chunk_result) {
+            return parse_ohlc_history_csv_chunk(chunk, start_time, end_time, chunk_ohlc_history, chunk_result);
+        });
     const std::time_t latency_end_time = std::time(nullptr);
     const size_t total_record = ohlc_history.size();
     logger(Logger::Severity::INFO) << "Loaded " << total_record << " OHLC ticks in "
@@ -179,18 +240,7 @@ OhlcHistory read_ohlc_history_from_csv_file(const std::string &file_name, const
 
 OhlcHistory read_ohlc_history_from_binary_file(const std::string &file_name, const std::time_t start_time,
                                                const std::time_t end_time) {
-    return read_history_from_binary_file<OhlcTick>(file_name, start_time, end_time, [](const OhlcTick &ohlc_tick) {
-        if (ohlc_tick.open <= 0 || ohlc_tick.high <= 0 || ohlc_tick.low <= 0 || ohlc_tick.close <= 0 ||
-            ohlc_tick.low > ohlc_tick.open || ohlc_tick.low > ohlc_tick.high || ohlc_tick.low > ohlc_tick.close ||
-            ohlc_tick.high < ohlc_tick.open || ohlc_tick.high < ohlc_tick.close) {
-            logError("Invalid OHLC prices");
-            return false;
-        }
-        if (ohlc_tick.volume < 0) {
-            logError("Invalid volume");
-        }
-        return true;
-    });
+    return read_history_from_binary_file<OhlcTick>(file_name, start_time, end_time, find_invalid_ohlc_ticks);
 }
 
 // Prints the top_n largest (chronologically sorted) price history gaps.
@@ -234,23 +284,24 @@ void print_outliers_with_context(PriceHistory::const_iterator begin, PriceHistor
     }
 }
 
-// clean outliers and update frequency of the price history into OHLC history.
-// Keeping Max_price_deviation_fix
-OhlcHistory convert_price_history_to_ohlc_history(const PriceHistory &price_history,
-                                                  const int interval_rate_sec = INTERVAL_RATE_SEC) {
+// clean outliers and update frequency of the price history into OHLC history for every interval rate.
+// Ticks flow through the outlier filter straight into OHLC ticks, so there is no cleaned copy of the price history.
+std::vector<OhlcHistory> convert_price_history_to_ohlc_history(const PriceHistory &price_history,
+                                                               const std::vector<int> &interval_rates_sec) {
     std::vector<size_t> outlier_indexes;
     Logger &logger = Logger::get_instance();
-    const PriceHistory price_history_clean =
-        clean_outliers(price_history.begin(), price_history.end(), MAX_PRICE_DEVIATION_PER_MIN, &outlier_indexes);
+    const std::vector<OhlcHistory> ohlc_histories = clean_outliers_and_update_data_frequency(
+        price_history.begin(), price_history.end(), MAX_PRICE_DEVIATION_PER_MIN, interval_rates_sec, &outlier_indexes);
 
     logger(Logger::Severity::INFO) << "Removed " << outlier_indexes.size() << " outliers" << Logger::endl;
     logger(Logger::Severity::INFO) << "Last " << LAST_N_OUTLIERS << " outliers:" << Logger::endl;
     print_outliers_with_context(price_history.begin(), price_history.end(), outlier_indexes, 5, 5, LAST_N_OUTLIERS);
-    const OhlcHistory ohlc_history =
-        update_data_frequency(price_history_clean.begin(), price_history_clean.end(), interval_rate_sec);
-    logger(Logger::Severity::INFO) << "Updated Frequency of " << price_history_clean.size() << " records to "
-                                   << ohlc_history.size() << " OHLC ticks" << Logger::endl;
-    return ohlc_history;
+    for (size_t i = 0; i < ohlc_histories.size(); ++i) {
+        logger(Logger::Severity::INFO) << "Updated Frequency of " << price_history.size() - outlier_indexes.size()
+                                       << " records to " << ohlc_histories[i].size() << " OHLC ticks ("
+                                       << interval_rates_sec[i] << " sec)" << Logger::endl;
+    }
+    return ohlc_histories;
 }
 
 } // namespace back_trader
@@ -275,7 +326,9 @@ int main(int argc, char *argv[]) {
 
     std::string input_ohlc_history_csv_file = arg_map["input_ohlc_history_csv_file"];
     std::string input_ohlc_history_binary_file = arg_map["input_ohlc_history_binary_file"];
-    std::string output_ohlc_history_binary_file = arg_map["output_ohlc_history_binary_file"];
+    // One output file for every interval rate (comma separated)
+    std::vector<std::string> output_ohlc_history_binary_files =
+        split_arg_list(arg_map["output_ohlc_history_binary_file"]);
 
     std::string input_fear_and_greed_history_csv_file = arg_map["input_fear_and_greed_history_csv_file"];
     std::string output_fear_and_greed_history_binary_file = arg_map["output_fear_and_greed_history_binary_file"];
@@ -283,8 +336,12 @@ int main(int argc, char *argv[]) {
     double max_price_deviation_per_min = arg_map["max_price_deviation_per_min"] == ""
                                              ? MAX_PRICE_DEVIATION_PER_MIN
                                              : std::stod(arg_map["max_price_deviation_per_min"]);
-    int interval_rate_sec =
-        arg_map["interval_rate_sec"] == "" ? interval_rate_sec : std::stoi(arg_map["interval_rate_sec"]);
+    // All interval rates are built in a single pass, coarser ones from the finer ones (ex:- 300,1800,3600)
+    std::vector<int> interval_rates_sec;
+    for (const std::string &interval_rate_sec : split_arg_list(arg_map["interval_rate_sec"]))
+        interval_rates_sec.push_back(std::stoi(interval_rate_sec));
+    if (interval_rates_sec.empty())
+        interval_rates_sec.push_back(INTERVAL_RATE_SEC);
     int top_n_gaps = arg_map["top_n_gaps"] == "" ? TOP_N_GAPS : std::stoi(arg_map["top_n_gaps"]);
     int last_n_outliers = arg_map["last_n_outliers"] == "" ? LAST_N_OUTLIERS : std::stoi(arg_map["last_n_outliers"]);
     bool compress_in_byte =
@@ -293,6 +350,9 @@ int main(int argc, char *argv[]) {
         (arg_map["start_time"] == "" ? convert_time_string(START_TIME) : convert_time_string(arg_map["start_time"]));
     std::time_t end_time =
         arg_map["end_time"] == "" ? convert_time_string(END_TIME) : convert_time_string(arg_map["end_time"]);
+    size_t threads = arg_map["threads"] == "" ? INGESTION_THREADS : std::stoul(arg_map["threads"]);
+    bool append_ohlc_history =
+        arg_map["append_ohlc_history"] == "" ? APPEND_OHLC_HISTORY : std::stoi(arg_map["append_ohlc_history"]);
     logger(Logger::Severity::INFO) << "Selected time period:- "
                                    << "[" << formate_time_utc(start_time, "%Y-%m-%d %H:%M:%S") << "] - ["
                                    << formate_time_utc(end_time, "%Y-%m-%d %H:%M:%S") << ")" << Logger::endl;
@@ -327,10 +387,26 @@ int main(int argc, char *argv[]) {
         std::exit(EXIT_FAILURE);
     }
 
-    // Read PriceRecord(TPV) from csv or binary
+    // Error :- Converting price history needs one output file for every interval rate, OHLC history is just rewritten
+    const size_t expected_output_ohlc_files = read_price_history ? interval_rates_sec.size() : 1;
+    if (!output_ohlc_history_binary_files.empty() &&
+        output_ohlc_history_binary_files.size() != expected_output_ohlc_files) {
+        logError(string_format("Expected ", expected_output_ohlc_files, " output OHLC history files but got ",
+                               output_ohlc_history_binary_files.size()));
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Error :- Appending needs new price history and existing raw OHLC history files
+    if (append_ohlc_history && (!read_price_history || output_ohlc_history_binary_files.empty() || compress_in_byte)) {
+        logError("Appending needs input price history and uncompressed output OHLC history files");
+        std::exit(EXIT_FAILURE);
+    }
+
+    /* Read PriceRecord(TPV) from csv or binary. Whole selected range is in memory (gaps, outliers and price history
+     output need it), only the conversion into OHLC ticks streams (see clean_outliers_and_update_data_frequency). */
     PriceHistory price_history = [&]() {
         if (!input_price_history_csv_file.empty()) {
-            return read_price_history_from_csv_file(input_price_history_csv_file, start_time, end_time);
+            return read_price_history_from_csv_file(input_price_history_csv_file, start_time, end_time, threads);
         } else if (!input_price_history_binary_file.empty()) {
             return read_price_histry_from_binary_file(input_price_history_binary_file, start_time, end_time);
         }
@@ -340,7 +416,7 @@ int main(int argc, char *argv[]) {
     // Read OhlcTick(OHLC) from csv or binary
     OhlcHistory ohlc_history = [&]() {
         if (!input_ohlc_history_csv_file.empty()) {
-            return read_ohlc_history_from_csv_file(input_ohlc_history_csv_file, start_time, end_time);
+            return read_ohlc_history_from_csv_file(input_ohlc_history_csv_file, start_time, end_time, threads);
         } else if (!input_ohlc_history_binary_file.empty()) {
             return read_ohlc_history_from_binary_file(input_ohlc_history_binary_file, start_time, end_time);
         }
@@ -356,15 +432,41 @@ int main(int argc, char *argv[]) {
         print_price_history_gaps(price_history, top_n_gaps);
     }
 
-    if (!price_history.empty() && ohlc_history.empty() && !output_ohlc_history_binary_file.empty()) {
-        ohlc_history = convert_price_history_to_ohlc_history(price_history, interval_rate_sec);
+    if (append_ohlc_history) {
+        if (!price_history.empty() && !append_price_history_to_ohlc_history_files(
+                                           price_history, MAX_PRICE_DEVIATION_PER_MIN, interval_rates_sec,
+                                           output_ohlc_history_binary_files))
+            std::exit(EXIT_FAILURE);
+        logger.close();
+        return 0;
+    }
+
+    // OHLC history built from price history can be appended later, it's continued after the last price record
+    const int64_t last_source_timestamp_sec =
+        ohlc_history.empty() && !price_history.empty() ? price_history.back().timestamp_sec : 0;
+    std::vector<OhlcHistory> ohlc_histories;
+    if (!ohlc_history.empty()) {
+        ohlc_histories.push_back(std::move(ohlc_history));
+    } else if (!price_history.empty() && !output_ohlc_history_binary_files.empty()) {
+        ohlc_histories = convert_price_history_to_ohlc_history(price_history, interval_rates_sec);
     }
 
+    // Compressed files are several times smaller but have to be decoded, raw files are used in place (memory mapped)
+    const auto write_history = [compress_in_byte](const auto &history, const std::string &output_file,
+                                                  int64_t last_source_timestamp_sec = 0) {
+        if (compress_in_byte)
+            write_compressed_history_to_binary_file(history, output_file);
+        else
+            write_history_to_binary_file(history, output_file, last_source_timestamp_sec);
+    };
+
     if (!price_history.empty() && !output_price_history_binary_file.empty())
-        write_history_to_binary_file(price_history, output_price_history_binary_file);
+        write_history(price_history, output_price_history_binary_file);
 
-    if (!ohlc_history.empty() && !output_ohlc_history_binary_file.empty())
-        write_history_to_binary_file(ohlc_history, output_ohlc_history_binary_file);
+    for (size_t i = 0; i < ohlc_histories.size() && i < output_ohlc_history_binary_files.size(); ++i) {
+        if (!ohlc_histories[i].empty())
+            write_history(ohlc_histories[i], output_ohlc_history_binary_files[i], last_source_timestamp_sec);
+    }
 
     // std::cout << ohlc_history.size() << " " << ohlc_history.front().timestamp_sec << '\n';
     // std::cout << ohlc_history.size() << " " << ohlc_history.back().timestamp_sec << '\n';
@@ -0,0 +1,82 @@
+#include "test_history.hpp"
+#include <base_header.hpp>
+#include <cstddef>
+#include <ctime>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+
+namespace back_trader {
+namespace {
+// Same history written compressed and uncompressed into the test temporary directory.
+class CompressedHistoryTest : public ::testing::Test {
+  protected:
+    CompressedHistoryTest()
+        : _compressed_file_name(::testing::TempDir() + "compressed_history_test_compressed.mov"),
+          _file_name(::testing::TempDir() + "compressed_history_test.mov"),
+          // 4 whole blocks and a partial one
+          _ohlc_history(get_random_walk_ohlc_history(4 * CompressedHistoryBlockSize + 1000)) {
+        EXPECT_TRUE(write_compressed_history_to_binary_file(_ohlc_history, _compressed_file_name));
+        EXPECT_TRUE(write_history_to_binary_file(_ohlc_history, _file_name, 0));
+    }
+    ~CompressedHistoryTest() override {
+        std::filesystem::remove(_compressed_file_name);
+        std::filesystem::remove(_file_name);
+    }
+
+    // Timestamp of tick of ohlc_history.
+    std::time_t get_timestamp(size_t tick_index) const { return _ohlc_history[tick_index].timestamp_sec; }
+
+    std::string _compressed_file_name;
+    std::string _file_name;
+    OhlcHistory _ohlc_history;
+};
+
+TEST_F(CompressedHistoryTest, TimeRangeIsSameAsUncompressed) {
+    const size_t block_size = CompressedHistoryBlockSize;
+    // Whole history, within a block, over block boundaries and ending at the first tick of a block
+    for (const auto &[begin, end] : {std::pair<size_t, size_t>{0, _ohlc_history.size()},
+                                     {100, 200},
+                                     {block_size - 1, 3 * block_size + 1},
+                                     {block_size, 2 * block_size},
+                                     {3 * block_size + 10, _ohlc_history.size()}}) {
+        const std::time_t start_time = get_timestamp(begin);
+        const std::time_t end_time = end < _ohlc_history.size() ? get_timestamp(end) : 0;
+        const OhlcHistoryView compressed_ohlc_history =
+            read_history_view_from_binary_file<OhlcTick>(_compressed_file_name, start_time, end_time);
+        const OhlcHistoryView ohlc_history =
+            read_history_view_from_binary_file<OhlcTick>(_file_name, start_time, end_time);
+        ASSERT_EQ(compressed_ohlc_history.size(), end - begin);
+        ASSERT_EQ(ohlc_history.size(), end - begin);
+        for (size_t i = 0; i < ohlc_history.size(); ++i) {
+            ASSERT_EQ(compressed_ohlc_history[i].timestamp_sec, ohlc_history[i].timestamp_sec) << begin + i;
+            ASSERT_EQ(compressed_ohlc_history[i].open, ohlc_history[i].open) << begin + i;
+            ASSERT_EQ(compressed_ohlc_history[i].high, ohlc_history[i].high) << begin + i;
+            ASSERT_EQ(compressed_ohlc_history[i].low, ohlc_history[i].low) << begin + i;
+            ASSERT_EQ(compressed_ohlc_history[i].close, ohlc_history[i].close) << begin + i;
+            ASSERT_EQ(compressed_ohlc_history[i].volume, ohlc_history[i].volume) << begin + i;
+        }
+    }
+}
+
+TEST_F(CompressedHistoryTest, BlockIsDecodedOnlyWhenItsRecordsAreAccessed) {
+    ASSERT_TRUE(AllocationCountingEnabled) << "tests have to be built with COUNT_ALLOCATIONS";
+    const common_util::RMemoryMapped<char> read_file(_compressed_file_name);
+    const CompressedHistoryFileHeader *header = get_compressed_history_file_header(read_file.begin(), read_file.size());
+    ASSERT_NE(header, nullptr);
+    const CompressedHistory<OhlcTick> compressed_history(read_file.begin(), *header);
+    // Decoding a block allocates its records
+    const size_t allocation_count = thread_allocation_count();
+    CompressedHistory<OhlcTick>::const_iterator it = compressed_history.block_begin(0);
+    for (size_t i = 0; i < CompressedHistoryBlockSize; ++i)
+        ++it;
+    ASSERT_EQ(it.block(), 1u);
+    const CompressedHistory<OhlcTick>::const_iterator end = compressed_history.end();
+    EXPECT_EQ(thread_allocation_count(), allocation_count);
+    EXPECT_EQ(it->timestamp_sec, get_timestamp(CompressedHistoryBlockSize));
+    EXPECT_GT(thread_allocation_count(), allocation_count);
+    EXPECT_NE(it, end);
+}
+} // namespace
+} // namespace back_trader
@@ -0,0 +1,101 @@
+#include "execution/evaluation_result_file.hpp"
+#include "test_history.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace back_trader {
+namespace {
+SweepInputs get_test_sweep_inputs() {
+    SweepInputs sweep_inputs;
+    sweep_inputs.history_file_name = "../data/bitstamp_tick_data_1h.mov";
+    sweep_inputs.history_record_count = 1000;
+    sweep_inputs.history_last_timestamp_sec = TestHistoryStartTimestampSec + 999 * 60;
+    sweep_inputs.start_timestamp_sec = TestHistoryStartTimestampSec;
+    sweep_inputs.end_timestamp_sec = TestHistoryStartTimestampSec + 1000 * 60;
+    sweep_inputs.evaluation_window = {7, EvaluationTimeSpan::Unit::DAY};
+    sweep_inputs.evaluation_step = {1, EvaluationTimeSpan::Unit::DAY};
+    sweep_inputs.strategy_name = "stop";
+    sweep_inputs.account_config = get_test_account_config();
+    return sweep_inputs;
+}
+
+// Results files of shards of a sweep of 5 simulators written in the test temporary directory.
+class EvaluationResultFileTest : public ::testing::Test {
+  protected:
+    ~EvaluationResultFileTest() override {
+        for (const std::string &file_name : _file_names)
+            std::filesystem::remove(file_name);
+    }
+
+    std::string write_shard(size_t shard_index, uint64_t sweep_fingerprint) {
+        const SweepShard shard{shard_index, 2};
+        std::vector<SimulatorEvaluationResult> shard_results;
+        for (size_t i = shard.begin(SweepSize); i < shard.end(SweepSize); ++i) {
+            SimulatorEvaluationResult result{};
+            result.name = "simulator_" + std::to_string(i);
+            result.score = 1.0f / (i + 3);
+            shard_results.push_back(result);
+        }
+        const std::string file_name = ::testing::TempDir() + "evaluation_result_file_test_" +
+                                      std::to_string(_file_names.size()) + ".csv";
+        _file_names.push_back(file_name);
+        EXPECT_TRUE(write_evaluation_results_file(file_name, shard, SweepSize, sweep_fingerprint, shard_results));
+        return file_name;
+    }
+
+    static constexpr size_t SweepSize = 5;
+    std::vector<std::string> _file_names;
+};
+
+TEST(SweepFingerprintTest, DiffersForEveryInput) {
+    const SweepInputs sweep_inputs = get_test_sweep_inputs();
+    const uint64_t fingerprint = get_sweep_fingerprint(sweep_inputs);
+    EXPECT_EQ(get_sweep_fingerprint(get_test_sweep_inputs()), fingerprint);
+    // Directory of the history file is not an input, shards may run on other machines
+    SweepInputs moved_inputs = sweep_inputs;
+    moved_inputs.history_file_name = "/mnt/shared/bitstamp_tick_data_1h.mov";
+    EXPECT_EQ(get_sweep_fingerprint(moved_inputs), fingerprint);
+
+    const auto expect_other_fingerprint = [&](const auto &change_input) {
+        SweepInputs other_inputs = sweep_inputs;
+        change_input(other_inputs);
+        EXPECT_NE(get_sweep_fingerprint(other_inputs), fingerprint);
+    };
+    expect_other_fingerprint([](SweepInputs &inputs) { inputs.history_file_name = "bitstamp_tick_data_1min.mov"; });
+    expect_other_fingerprint([](SweepInputs &inputs) { ++inputs.history_record_count; });
+    expect_other_fingerprint([](SweepInputs &inputs) { inputs.history_last_timestamp_sec += 60; });
+    expect_other_fingerprint([](SweepInputs &inputs) { inputs.start_timestamp_sec += 60; });
+    expect_other_fingerprint([](SweepInputs &inputs) { inputs.end_timestamp_sec += 60; });
+    expect_other_fingerprint([](SweepInputs &inputs) { inputs.evaluation_window.count = 14; });
+    expect_other_fingerprint([](SweepInputs &inputs) { inputs.evaluation_step.count = 2; });
+    expect_other_fingerprint([](SweepInputs &inputs) { inputs.strategy_name = "rebalancing"; });
+    expect_other_fingerprint([](SweepInputs &inputs) { inputs.account_config.start_quote_balance += 1; });
+    expect_other_fingerprint([](SweepInputs &inputs) { inputs.account_config.limit_order_fee_config.fixed_fee = 1; });
+}
+
+TEST_F(EvaluationResultFileTest, ShardsOfSweepAreMerged) {
+    const uint64_t sweep_fingerprint = get_sweep_fingerprint(get_test_sweep_inputs());
+    const std::string second_shard = write_shard(1, sweep_fingerprint);
+    const std::string first_shard = write_shard(0, sweep_fingerprint);
+    std::vector<SimulatorEvaluationResult> sweep_results;
+    ASSERT_TRUE(read_evaluation_results_files({second_shard, first_shard}, sweep_results));
+    ASSERT_EQ(sweep_results.size(), SweepSize);
+    for (size_t i = 0; i < SweepSize; ++i) {
+        EXPECT_EQ(sweep_results[i].name, "simulator_" + std::to_string(i));
+        EXPECT_EQ(sweep_results[i].score, 1.0f / (i + 3));
+    }
+}
+
+TEST_F(EvaluationResultFileTest, ShardsOfSweepsOverOtherInputsAreNotMerged) {
+    SweepInputs other_inputs = get_test_sweep_inputs();
+    other_inputs.history_record_count += 60;
+    const std::string first_shard = write_shard(0, get_sweep_fingerprint(get_test_sweep_inputs()));
+    const std::string second_shard = write_shard(1, get_sweep_fingerprint(other_inputs));
+    std::vector<SimulatorEvaluationResult> sweep_results;
+    EXPECT_FALSE(read_evaluation_results_files({first_shard, second_shard}, sweep_results));
+}
+} // namespace
+} // namespace back_trader
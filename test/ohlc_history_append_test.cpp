@@ -0,0 +1,139 @@
+#include "test_history.hpp"
+#include <algorithm>
+#include <base_header.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace back_trader {
+namespace {
+constexpr float TestMaxPriceDeviationPerMin = 0.05f;
+// Every interval except the first one is built from a finer one.
+const std::vector<int> TestIntervalRatesSec = {60, 300, 900, 3600};
+// Every OutlierSpacing-th price record is a single record spike.
+constexpr size_t OutlierSpacing = 1000;
+
+/*
+ Price records every 1 to 20 seconds, random walk of the price around 30000 with seed. Every 7000th record comes after
+ a gap of a few hours, every OutlierSpacing-th record is an outlier.
+*/
+PriceHistory get_random_walk_price_history(size_t record_count, uint32_t seed) {
+    std::mt19937 random_generator(seed);
+    std::normal_distribution<float> return_distribution(0.0f, 0.0005f);
+    std::uniform_int_distribution<int64_t> step_distribution(1, 20);
+    std::uniform_int_distribution<int64_t> gap_distribution(2 * 60 * 60, 5 * 60 * 60);
+    std::uniform_real_distribution<float> volume_distribution(0.01f, 2.0f);
+    PriceHistory price_history;
+    price_history.reserve(record_count);
+    int64_t timestamp_sec = TestHistoryStartTimestampSec;
+    float price = 30000.0f;
+    for (size_t i = 0; i < record_count; ++i) {
+        timestamp_sec += i % 7000 == 6999 ? gap_distribution(random_generator) : step_distribution(random_generator);
+        price *= std::exp(return_distribution(random_generator));
+        const float record_price = i % OutlierSpacing == OutlierSpacing / 2 ? price * 1.3f : price;
+        price_history.push_back({timestamp_sec, record_price, volume_distribution(random_generator)});
+    }
+    return price_history;
+}
+
+std::string read_file(const std::string &file_name) {
+    std::ifstream file(file_name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// OHLC history files of every test interval rate generated and appended in the test temporary directory.
+class OhlcHistoryAppendTest : public ::testing::Test {
+  protected:
+    OhlcHistoryAppendTest() : _price_history(get_random_walk_price_history(50000, 7)) {
+        for (const int interval_rate_sec : TestIntervalRatesSec) {
+            const std::string file_name =
+                ::testing::TempDir() + "ohlc_history_append_test_" + std::to_string(interval_rate_sec);
+            _generated_file_names.push_back(file_name + "_generated.mov");
+            _appended_file_names.push_back(file_name + "_appended.mov");
+        }
+        generate(_price_history.begin(), _price_history.end(), _generated_file_names);
+    }
+    ~OhlcHistoryAppendTest() override {
+        for (size_t i = 0; i < TestIntervalRatesSec.size(); ++i) {
+            std::filesystem::remove(_generated_file_names[i]);
+            std::filesystem::remove(_appended_file_names[i]);
+        }
+    }
+
+    // Same as data generator without appending, OHLC histories are built from price history at once.
+    static void generate(PriceHistory::const_iterator begin, PriceHistory::const_iterator end,
+                         const std::vector<std::string> &file_names) {
+        const std::vector<OhlcHistory> ohlc_histories = clean_outliers_and_update_data_frequency(
+            begin, end, TestMaxPriceDeviationPerMin, TestIntervalRatesSec, nullptr);
+        for (size_t i = 0; i < ohlc_histories.size(); ++i)
+            ASSERT_TRUE(write_history_to_binary_file(ohlc_histories[i], file_names[i], std::prev(end)->timestamp_sec));
+    }
+
+    // Appends price records [begin, end) of test price history to the appended files.
+    void append(size_t begin, size_t end) {
+        const PriceHistory price_history(_price_history.begin() + begin, _price_history.begin() + end);
+        ASSERT_TRUE(append_price_history_to_ohlc_history_files(price_history, TestMaxPriceDeviationPerMin,
+                                                               TestIntervalRatesSec, _appended_file_names));
+    }
+
+    void expect_same_files() {
+        for (size_t i = 0; i < TestIntervalRatesSec.size(); ++i) {
+            const std::string generated_file = read_file(_generated_file_names[i]);
+            ASSERT_FALSE(generated_file.empty());
+            EXPECT_TRUE(read_file(_appended_file_names[i]) == generated_file)
+                << TestIntervalRatesSec[i] << " sec OHLC history differs";
+        }
+    }
+
+    PriceHistory _price_history;
+    std::vector<std::string> _generated_file_names;
+    std::vector<std::string> _appended_file_names;
+};
+
+TEST_F(OhlcHistoryAppendTest, AppendedInTwoPartsIsSameAsGenerated) {
+    // Within OHLC ticks of every interval (records are seconds apart) and right after a gap, away from outliers
+    for (const size_t split : {size_t(12345), size_t(20300), size_t(7000)}) {
+        generate(_price_history.begin(), _price_history.begin() + split, _appended_file_names);
+        append(split, _price_history.size());
+        expect_same_files();
+    }
+}
+
+TEST_F(OhlcHistoryAppendTest, AppendedInManyPartsIsSameAsGenerated) {
+    generate(_price_history.begin(), _price_history.begin() + 3300, _appended_file_names);
+    for (size_t split = 3300; split < _price_history.size(); split += 4000)
+        append(split, std::min(split + 4000, _price_history.size()));
+    expect_same_files();
+}
+
+TEST_F(OhlcHistoryAppendTest, RecordsAlreadyInHistoryAreSkipped) {
+    generate(_price_history.begin(), _price_history.begin() + 25400, _appended_file_names);
+    append(24600, _price_history.size());
+    expect_same_files();
+}
+
+TEST_F(OhlcHistoryAppendTest, InterruptedAppendIsRepeated) {
+    // Last OHLC tick of the first part is updated by the append
+    ASSERT_EQ(_price_history[30601].timestamp_sec / 60, _price_history[30600].timestamp_sec / 60);
+    generate(_price_history.begin(), _price_history.begin() + 30601, _appended_file_names);
+    // Records and index are written, headers (written last) are still the ones before the append
+    std::vector<std::string> headers;
+    for (const std::string &file_name : _appended_file_names)
+        headers.push_back(read_file(file_name).substr(0, sizeof(HistoryFileHeader)));
+    append(30601, _price_history.size());
+    for (size_t i = 0; i < TestIntervalRatesSec.size(); ++i) {
+        std::fstream file(_appended_file_names[i], std::ios::in | std::ios::out | std::ios::binary);
+        file.write(headers[i].data(), headers[i].size());
+    }
+    append(30601, _price_history.size());
+    expect_same_files();
+}
+} // namespace
+} // namespace back_trader
@@ -0,0 +1,167 @@
+#include "test_history.hpp"
+#include <algorithm>
+#include <base_header.hpp>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace back_trader {
+namespace {
+// Range of ticks [begin, end) by scanning every tick.
+OhlcRange get_brute_force_range(const OhlcTick *begin, const OhlcTick *end) {
+    OhlcRange range{begin->low, begin->high};
+    for (const OhlcTick *ohlc_tick = begin; ohlc_tick != end; ++ohlc_tick) {
+        range.low = std::min(range.low, ohlc_tick->low);
+        range.high = std::max(range.high, ohlc_tick->high);
+    }
+    return range;
+}
+
+// Checks ranges of index against brute force over every range of up to 3 blocks and random ranges of ohlc_history.
+void expect_brute_force_ranges(const OhlcRangeIndex &ohlc_range_index, const OhlcHistoryView &ohlc_history,
+                               uint32_t seed) {
+    ASSERT_TRUE(ohlc_range_index.covers(ohlc_history));
+    const OhlcTick *ticks = ohlc_history.begin();
+    const size_t short_range = std::min(ohlc_history.size(), 3 * OhlcRangeIndex::BlockSize);
+    for (size_t begin = 0; begin < short_range; ++begin) {
+        for (size_t end = begin + 1; end <= short_range; ++end) {
+            const OhlcRange range = ohlc_range_index.get_range(ticks + begin, ticks + end);
+            const OhlcRange expected_range = get_brute_force_range(ticks + begin, ticks + end);
+            ASSERT_EQ(range.low, expected_range.low) << "[" << begin << ", " << end << ")";
+            ASSERT_EQ(range.high, expected_range.high) << "[" << begin << ", " << end << ")";
+        }
+    }
+    std::mt19937 random_generator(seed);
+    std::uniform_int_distribution<size_t> index_distribution(0, ohlc_history.size() - 1);
+    for (int i = 0; i < 2000; ++i) {
+        size_t begin = index_distribution(random_generator);
+        size_t end = index_distribution(random_generator);
+        if (begin > end)
+            std::swap(begin, end);
+        ++end;
+        const OhlcRange range = ohlc_range_index.get_range(ticks + begin, ticks + end);
+        const OhlcRange expected_range = get_brute_force_range(ticks + begin, ticks + end);
+        ASSERT_EQ(range.low, expected_range.low) << "[" << begin << ", " << end << ")";
+        ASSERT_EQ(range.high, expected_range.high) << "[" << begin << ", " << end << ")";
+    }
+}
+
+TEST(OhlcRangeIndexTest, MatchesBruteForce) {
+    // Histories shorter than a block, of whole blocks and with the last block partial
+    for (const size_t tick_count : {1, 7, 32, 64, 1000, 10007}) {
+        const OhlcHistory ohlc_history = get_random_walk_ohlc_history(tick_count, tick_count);
+        const OhlcHistoryView ohlc_history_view(ohlc_history);
+        const OhlcColumns ohlc_columns(ohlc_history_view);
+        const OhlcRangeIndex ohlc_range_index(ohlc_history_view, ohlc_columns);
+        ASSERT_EQ(ohlc_range_index.size(), tick_count);
+        expect_brute_force_ranges(ohlc_range_index, ohlc_history_view, tick_count);
+    }
+}
+
+TEST(OhlcRangeIndexTest, TimeRangeViewOffsetsIntoIndex) {
+    const OhlcHistory ohlc_history = get_random_walk_ohlc_history(10000, 3);
+    const OhlcHistoryView ohlc_history_view(ohlc_history);
+    const OhlcColumns ohlc_columns(ohlc_history_view);
+    const OhlcRangeIndex ohlc_range_index(ohlc_history_view, ohlc_columns);
+    const auto time_range = history_subset(ohlc_history_view, TestHistoryStartTimestampSec + 1234 * 60,
+                                           TestHistoryStartTimestampSec + 8765 * 60);
+    const OhlcHistoryView time_range_view = ohlc_history_view.subview(time_range.first, time_range.second);
+    ASSERT_EQ(time_range_view.size(), 8765u - 1234u);
+    expect_brute_force_ranges(ohlc_range_index, time_range_view, 3);
+    EXPECT_FALSE(OhlcRangeIndex(time_range_view, OhlcColumns(time_range_view)).covers(ohlc_history_view));
+}
+
+// Index persisted next to history file written into the test temporary directory.
+class PersistedOhlcRangeIndexTest : public ::testing::Test {
+  protected:
+    PersistedOhlcRangeIndexTest()
+        : _history_file_name(::testing::TempDir() + "ohlc_range_index_test.mov"),
+          _range_index_file_name(_history_file_name + ".range_index"),
+          _ohlc_history(get_random_walk_ohlc_history(5000)) {
+        std::filesystem::remove(_range_index_file_name);
+        const int64_t last_source_timestamp_sec = _ohlc_history.back().timestamp_sec;
+        EXPECT_TRUE(write_history_to_binary_file(_ohlc_history, _history_file_name, last_source_timestamp_sec));
+    }
+    ~PersistedOhlcRangeIndexTest() override {
+        std::filesystem::remove(_history_file_name);
+        std::filesystem::remove(_range_index_file_name);
+    }
+
+    // Builds index of the whole history file and writes it next to the file.
+    void write_range_index() {
+        const OhlcHistoryView file_ohlc_history =
+            read_history_view_from_binary_file<OhlcTick>(_history_file_name, 0, 0);
+        const OhlcColumns ohlc_columns(file_ohlc_history);
+        const OhlcRangeIndex ohlc_range_index(file_ohlc_history, ohlc_columns);
+        RangeIndexSource source;
+        ASSERT_TRUE(get_range_index_source(_history_file_name, source));
+        ASSERT_TRUE(ohlc_range_index.write_to_file(_range_index_file_name, source));
+    }
+
+    // Reads index of the whole history file persisted next to it.
+    bool read_range_index(const OhlcHistoryView &file_ohlc_history, OhlcRangeIndex &ohlc_range_index) {
+        RangeIndexSource source;
+        return get_range_index_source(_history_file_name, source) &&
+               ohlc_range_index.read_from_file(_range_index_file_name, source, file_ohlc_history);
+    }
+
+    std::string _history_file_name;
+    std::string _range_index_file_name;
+    OhlcHistory _ohlc_history;
+};
+
+TEST_F(PersistedOhlcRangeIndexTest, ReadIndexMatchesBruteForce) {
+    write_range_index();
+    const OhlcHistoryView file_ohlc_history = read_history_view_from_binary_file<OhlcTick>(_history_file_name, 0, 0);
+    OhlcRangeIndex ohlc_range_index;
+    ASSERT_TRUE(read_range_index(file_ohlc_history, ohlc_range_index));
+    ASSERT_EQ(ohlc_range_index.size(), _ohlc_history.size());
+    expect_brute_force_ranges(ohlc_range_index, file_ohlc_history, 5);
+    // Time range of the mapped file is a view into the same index
+    const OhlcHistoryView time_range_view = file_ohlc_history.subview(file_ohlc_history.begin() + 1000,
+                                                                      file_ohlc_history.begin() + 3000);
+    expect_brute_force_ranges(ohlc_range_index, time_range_view, 5);
+}
+
+TEST_F(PersistedOhlcRangeIndexTest, IndexOfMissingFileIsNotRead) {
+    const OhlcHistoryView file_ohlc_history = read_history_view_from_binary_file<OhlcTick>(_history_file_name, 0, 0);
+    OhlcRangeIndex ohlc_range_index;
+    EXPECT_FALSE(read_range_index(file_ohlc_history, ohlc_range_index));
+    EXPECT_EQ(ohlc_range_index.size(), 0u);
+}
+
+TEST_F(PersistedOhlcRangeIndexTest, IndexOfTimeRangeIsNotRead) {
+    write_range_index();
+    const OhlcHistoryView time_range_ohlc_history =
+        read_history_view_from_binary_file<OhlcTick>(_history_file_name, TestHistoryStartTimestampSec + 60, 0);
+    OhlcRangeIndex ohlc_range_index;
+    EXPECT_FALSE(read_range_index(time_range_ohlc_history, ohlc_range_index));
+}
+
+TEST_F(PersistedOhlcRangeIndexTest, IndexOfUpdatedTailIsNotRead) {
+    write_range_index();
+    // Last tick updated by new price records (same number of ticks and timestamps)
+    OhlcTick last_tick = _ohlc_history.back();
+    last_tick.low /= 2;
+    ASSERT_TRUE(update_history_tail_in_binary_file(std::vector<OhlcTick>{last_tick}, _ohlc_history.size() - 1,
+                                                   _history_file_name, last_tick.timestamp_sec + 30));
+    const OhlcHistoryView file_ohlc_history = read_history_view_from_binary_file<OhlcTick>(_history_file_name, 0, 0);
+    OhlcRangeIndex ohlc_range_index;
+    EXPECT_FALSE(read_range_index(file_ohlc_history, ohlc_range_index));
+}
+
+TEST_F(PersistedOhlcRangeIndexTest, IndexOfRegeneratedHistoryIsNotRead) {
+    write_range_index();
+    // Same header (ex:- regenerated with other outlier filter settings), only modification time differs
+    const std::filesystem::file_time_type modified_time = std::filesystem::last_write_time(_history_file_name);
+    std::filesystem::last_write_time(_history_file_name, modified_time + std::chrono::seconds(1));
+    const OhlcHistoryView file_ohlc_history = read_history_view_from_binary_file<OhlcTick>(_history_file_name, 0, 0);
+    OhlcRangeIndex ohlc_range_index;
+    EXPECT_FALSE(read_range_index(file_ohlc_history, ohlc_range_index));
+}
+} // namespace
+} // namespace back_trader
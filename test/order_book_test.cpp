@@ -0,0 +1,255 @@
+#include "test_history.hpp"
+#include <base_header.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace back_trader {
+namespace {
+/*
+ Reference (brute force) order book, orders are kept in the order of placement and every order is checked on every
+ OHLC tick. Same rules as documented for OrderBook.
+*/
+class ReferenceOrderBook {
+  public:
+    struct ReferenceOrder {
+        OrderId order_id;
+        Order order;
+        bool active;
+    };
+
+    void place(OrderId order_id, const Order &order) { _orders.push_back({order_id, order, true}); }
+
+    const Order *find(OrderId order_id) const {
+        for (const ReferenceOrder &reference_order : _orders) {
+            if (reference_order.active && reference_order.order_id == order_id)
+                return &reference_order.order;
+        }
+        return nullptr;
+    }
+
+    bool modify(OrderId order_id, float amount, float price) {
+        Order *order = const_cast<Order *>(find(order_id));
+        if (order == nullptr)
+            return false;
+        order->amount = amount;
+        order->price = price;
+        return true;
+    }
+
+    bool cancel(OrderId order_id) {
+        for (ReferenceOrder &reference_order : _orders) {
+            if (reference_order.active && reference_order.order_id == order_id) {
+                reference_order.active = false;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t size() const {
+        size_t size = 0;
+        for (const ReferenceOrder &reference_order : _orders)
+            size += reference_order.active ? 1 : 0;
+        return size;
+    }
+
+    int execute(const AccountConfig &account_config, const OhlcTick &ohlc_tick, SimulationAccount &account,
+                std::vector<Order> &executed_orders) {
+        std::vector<ReferenceOrder *> triggered_orders;
+        for (ReferenceOrder &reference_order : _orders) {
+            if (reference_order.active && is_triggered(reference_order.order, ohlc_tick))
+                triggered_orders.push_back(&reference_order);
+        }
+        int executed_count = 0;
+        for (ReferenceOrder *reference_order : triggered_orders) {
+            Order &order = reference_order->order;
+            const float base_balance = get_base_balance(account);
+            const float quote_balance = get_quote_balance(account);
+            if (!account.execute_order(account_config, order, ohlc_tick)) {
+                reference_order->active = order.type == Order::Type::LIMIT;
+                continue;
+            }
+            ++executed_count;
+            executed_orders.push_back(order);
+            reference_order->active = keeps_remaining_amount(account_config, ohlc_tick, account, order,
+                                                             get_base_balance(account) - base_balance,
+                                                             get_quote_balance(account) - quote_balance);
+            if (reference_order->active)
+                ++_partial_fill_counts[static_cast<size_t>(order.amount_kind)];
+        }
+        return executed_count;
+    }
+
+    // Number of executed limit orders of amount_kind which kept remaining amount.
+    size_t partial_fill_count(Order::AmountKind amount_kind) const {
+        return _partial_fill_counts[static_cast<size_t>(amount_kind)];
+    }
+
+    // Every order placed so far (filled and cancelled ones are not active).
+    const std::vector<ReferenceOrder> &orders() const { return _orders; }
+
+  private:
+    std::vector<ReferenceOrder> _orders;
+    size_t _partial_fill_counts[static_cast<size_t>(Order::AmountKind::Count)] = {};
+
+    // Market orders on the next tick, limit buy and stop sell when the price falls to them, the rest when it rises.
+    static bool is_triggered(const Order &order, const OhlcTick &ohlc_tick) {
+        if (order.type == Order::Type::MARKET)
+            return true;
+        if ((order.type == Order::Type::LIMIT) == (order.side == Order::Side::BUY))
+            return ohlc_tick.low <= order.price;
+        return ohlc_tick.high >= order.price;
+    }
+
+    /* Executed limit order which wasn't filled completely keeps the remaining amount, of at least one unit. Fill of
+     quote amount is partial only when max_volume_ratio capped its base amount. */
+    static bool keeps_remaining_amount(const AccountConfig &account_config, const OhlcTick &ohlc_tick,
+                                       const SimulationAccount &account, Order &order, float base_change,
+                                       float quote_change) {
+        if (order.type != Order::Type::LIMIT)
+            return false;
+        const float filled_base_amount = std::abs(base_change);
+        float remaining_amount;
+        float unit;
+        if (order.amount_kind == Order::AmountKind::BASE) {
+            remaining_amount = order.amount - filled_base_amount;
+            unit = account.base_unit;
+        } else {
+            const float max_base_amount = account_config.max_volume_ratio * ohlc_tick.volume;
+            if (account_config.max_volume_ratio <= 0 || filled_base_amount + account.base_unit <= max_base_amount)
+                return false;
+            remaining_amount = order.amount - (order.side == Order::Side::BUY ? -quote_change : quote_change);
+            unit = account.quote_unit;
+        }
+        if (remaining_amount <= 0 || remaining_amount < unit)
+            return false;
+        order.amount = remaining_amount;
+        return true;
+    }
+};
+
+// Places, modifies and cancels random orders on both books and executes them on random walk OHLC history.
+class OrderBookTest : public ::testing::TestWithParam<uint32_t> {
+  protected:
+    OrderBookTest()
+        : _random_generator(GetParam()), _ohlc_history(get_random_walk_ohlc_history(1000, GetParam())),
+          _account_config(get_test_account_config()), _order_book(16) {
+        // Big enough balances for orders to be capped by max_volume_ratio (every tick trades 1 to 100 base)
+        _account_config.start_base_balance = 200.0f;
+        _account_config.start_quote_balance = 6000000.0f;
+        _account.init_account(_account_config);
+        _reference_account.init_account(_account_config);
+    }
+
+    Order get_random_order(const OhlcTick &ohlc_tick) {
+        std::uniform_int_distribution<int> kind_distribution(0, static_cast<int>(Order::KindCount) - 1);
+        std::uniform_real_distribution<float> price_distribution(0.98f, 1.02f);
+        std::uniform_real_distribution<float> base_amount_distribution(0.001f, 60.0f);
+        const int kind = kind_distribution(_random_generator);
+        Order order;
+        order.amount_kind = static_cast<Order::AmountKind>(kind % static_cast<int>(Order::AmountKind::Count));
+        order.side = static_cast<Order::Side>(kind / static_cast<int>(Order::AmountKind::Count) %
+                                              static_cast<int>(Order::Side::Count));
+        order.type = static_cast<Order::Type>(kind / static_cast<int>(Order::AmountKind::Count) /
+                                              static_cast<int>(Order::Side::Count));
+        order.price = ohlc_tick.close * price_distribution(_random_generator);
+        order.amount = base_amount_distribution(_random_generator);
+        if (order.amount_kind == Order::AmountKind::QUOTE)
+            order.amount *= order.price;
+        return order;
+    }
+
+    // Random id of an order placed before (maybe already filled or cancelled) or id which was never placed.
+    OrderId get_random_order_id() {
+        if (_order_ids.empty())
+            return 12345;
+        std::uniform_int_distribution<size_t> index_distribution(0, _order_ids.size() - 1);
+        return _order_ids[index_distribution(_random_generator)];
+    }
+
+    void expect_same_books() {
+        ASSERT_EQ(_order_book.size(), _reference_order_book.size());
+        for (const ReferenceOrderBook::ReferenceOrder &reference_order : _reference_order_book.orders()) {
+            const Order *order = _order_book.find(reference_order.order_id);
+            ASSERT_EQ(order != nullptr, reference_order.active) << "order " << reference_order.order_id;
+            if (order != nullptr) {
+                ASSERT_EQ(order->amount, reference_order.order.amount) << "order " << reference_order.order_id;
+                ASSERT_EQ(order->price, reference_order.order.price) << "order " << reference_order.order_id;
+                ASSERT_EQ(order->kind(), reference_order.order.kind()) << "order " << reference_order.order_id;
+            }
+        }
+        ASSERT_EQ(get_base_balance(_account), get_base_balance(_reference_account));
+        ASSERT_EQ(get_quote_balance(_account), get_quote_balance(_reference_account));
+    }
+
+    std::mt19937 _random_generator;
+    OhlcHistory _ohlc_history;
+    AccountConfig _account_config;
+    SimulationAccount _account;
+    SimulationAccount _reference_account;
+    OrderBook _order_book;
+    ReferenceOrderBook _reference_order_book;
+    std::vector<OrderId> _order_ids;
+};
+
+TEST_P(OrderBookTest, MatchesReferenceOrderBook) {
+    std::uniform_int_distribution<int> operation_distribution(0, 9);
+    std::uniform_real_distribution<float> modify_distribution(0.5f, 1.5f);
+    for (size_t i = 1; i < _ohlc_history.size(); ++i) {
+        const OhlcTick &last_ohlc_tick = _ohlc_history[i - 1];
+        // Few operations between the OHLC ticks, more places than cancels so the book grows over its capacity
+        while (true) {
+            const int operation = operation_distribution(_random_generator);
+            if (operation < 4) {
+                const Order order = get_random_order(last_ohlc_tick);
+                const OrderId order_id = _order_book.place(order);
+                _reference_order_book.place(order_id, order);
+                _order_ids.push_back(order_id);
+            } else if (operation < 6) {
+                const OrderId order_id = get_random_order_id();
+                const Order *order = _reference_order_book.find(order_id);
+                // Filled, cancelled or unknown order isn't modified whatever the amount and price are
+                float amount = 1;
+                float price = 1;
+                if (order != nullptr) {
+                    amount = order->amount * modify_distribution(_random_generator);
+                    price = order->type == Order::Type::MARKET ? order->price
+                                                               : order->price * modify_distribution(_random_generator);
+                }
+                ASSERT_EQ(_order_book.modify(order_id, amount, price),
+                          _reference_order_book.modify(order_id, amount, price));
+            } else if (operation < 7) {
+                const OrderId order_id = get_random_order_id();
+                ASSERT_EQ(_order_book.cancel(order_id), _reference_order_book.cancel(order_id));
+            } else {
+                break;
+            }
+            expect_same_books();
+        }
+
+        std::vector<Order> executed_orders;
+        const int executed_count = _order_book.execute(_account_config, _ohlc_history[i], _account,
+                                                       [&](const Order &order) { executed_orders.push_back(order); });
+        std::vector<Order> reference_executed_orders;
+        ASSERT_EQ(executed_count, _reference_order_book.execute(_account_config, _ohlc_history[i],
+                                                                _reference_account, reference_executed_orders));
+        ASSERT_EQ(executed_orders.size(), reference_executed_orders.size());
+        for (size_t j = 0; j < executed_orders.size(); ++j) {
+            ASSERT_EQ(executed_orders[j].kind(), reference_executed_orders[j].kind());
+            ASSERT_EQ(executed_orders[j].amount, reference_executed_orders[j].amount);
+            ASSERT_EQ(executed_orders[j].price, reference_executed_orders[j].price);
+        }
+        expect_same_books();
+    }
+    // Limit orders of both amount kinds were capped by max_volume_ratio
+    EXPECT_GT(_reference_order_book.partial_fill_count(Order::AmountKind::BASE), 0u);
+    EXPECT_GT(_reference_order_book.partial_fill_count(Order::AmountKind::QUOTE), 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(RandomOrders, OrderBookTest, ::testing::Range(1u, 11u));
+} // namespace
+} // namespace back_trader
@@ -0,0 +1,157 @@
+#include "execution/simulation_executor.hpp"
+#include "simulators/simulator_factory.hpp"
+#include "simulators/strategy/rebalancing_trade_simulator.hpp"
+#include "simulators/strategy/stop_trade_simulator.hpp"
+#include "test_history.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace back_trader {
+namespace {
+/*
+ Simulator forwarding to Simulator, counts allocations of the calling thread from its first update (the setup of the
+ simulation is done) until allocations_since_first_update is called after the simulation returned its result.
+*/
+template <typename Simulator>
+class AllocationCountingSimulator final : public TradeSimulator {
+  public:
+    template <typename Config>
+    explicit AllocationCountingSimulator(const Config &config) : _simulator(config) {}
+
+    void update(const OhlcTick &ohlc_tick, const std::vector<float> &fear_and_greed_input_signals, float base_balance,
+                float quote_balance, std::vector<Order> &orders) override {
+        if (!_updated) {
+            _updated = true;
+            _first_update_allocation_count = thread_allocation_count();
+        }
+        _simulator.update(ohlc_tick, fear_and_greed_input_signals, base_balance, quote_balance, orders);
+    }
+    void write_internal_state(std::ostream &os) const override { _simulator.write_internal_state(os); }
+    size_t max_resting_orders() const override { return _simulator.max_resting_orders(); }
+    void attach_order_book(OrderBook *order_book) override { _simulator.attach_order_book(order_book); }
+    bool can_skip(const OhlcRange &ohlc_range) const override { return _simulator.can_skip(ohlc_range); }
+    void skip(const OhlcTick &last_tick) override { _simulator.skip(last_tick); }
+
+    bool updated() const { return _updated; }
+    size_t allocations_since_first_update() const { return thread_allocation_count() - _first_update_allocation_count; }
+
+  private:
+    Simulator _simulator;
+    bool _updated = false;
+    size_t _first_update_allocation_count = 0;
+};
+
+// Same as AllocationCountingSimulator for the lanes of batch_trade_simulator.
+class AllocationCountingBatchSimulator final : public BatchTradeSimulator {
+  public:
+    explicit AllocationCountingBatchSimulator(std::unique_ptr<BatchTradeSimulator> batch_trade_simulator)
+        : _batch_trade_simulator(std::move(batch_trade_simulator)) {}
+
+    size_t size() const override { return _batch_trade_simulator->size(); }
+    size_t max_orders_per_lane() const override { return _batch_trade_simulator->max_orders_per_lane(); }
+    void update(const OhlcTick &ohlc_tick, const float *base_balances, const float *quote_balances,
+                BatchOrders &orders) override {
+        if (!_updated) {
+            _updated = true;
+            _first_update_allocation_count = thread_allocation_count();
+        }
+        _batch_trade_simulator->update(ohlc_tick, base_balances, quote_balances, orders);
+    }
+    bool can_skip(const OhlcRange &ohlc_range) const override { return _batch_trade_simulator->can_skip(ohlc_range); }
+    void skip(const OhlcTick &last_tick) override { _batch_trade_simulator->skip(last_tick); }
+
+    bool updated() const { return _updated; }
+    size_t allocations_since_first_update() const { return thread_allocation_count() - _first_update_allocation_count; }
+
+  private:
+    std::unique_ptr<BatchTradeSimulator> _batch_trade_simulator;
+    bool _updated = false;
+    size_t _first_update_allocation_count = 0;
+};
+
+// 4 weeks of 1 minute ticks evaluated in weekly windows, with and without range index.
+class SimulationAllocationTest : public ::testing::Test {
+  protected:
+    SimulationAllocationTest()
+        : _ohlc_history(get_random_walk_ohlc_history(28 * 24 * 60)), _ohlc_history_view(_ohlc_history),
+          _ohlc_columns(_ohlc_history_view), _ohlc_range_index(_ohlc_history_view, _ohlc_columns),
+          _account_config(get_test_account_config()) {
+        const SimEvaluationConfig sim_evaluation_config = get_test_evaluation_config(_ohlc_history_view, 7, 7);
+        _evaluation_plans.push_back(get_evaluation_plan(sim_evaluation_config, _ohlc_history_view));
+        _evaluation_plans.push_back(get_evaluation_plan(sim_evaluation_config, _ohlc_history_view, &_ohlc_range_index));
+    }
+
+    template <typename Simulator, typename Config>
+    void expect_no_allocation(const std::vector<Config> &configs) {
+        for (const EvaluationPlan &evaluation_plan : _evaluation_plans) {
+            ASSERT_FALSE(evaluation_plan.periods.empty());
+            for (const EvaluationPeriod &evaluation_period : evaluation_plan.periods) {
+                for (const Config &config : configs) {
+                    AllocationCountingSimulator<Simulator> trade_simulator(config);
+                    NoSimulationLogger no_logger;
+                    const SimulationResult simulation_result = execute_trade_simulation(
+                        _account_config, evaluation_period, nullptr, true, trade_simulator, no_logger);
+                    ASSERT_TRUE(trade_simulator.updated());
+                    EXPECT_EQ(trade_simulator.allocations_since_first_update(), 0u);
+                    EXPECT_GT(simulation_result.end_value, 0);
+                }
+            }
+        }
+    }
+
+    void expect_no_batch_allocation(const std::string &strategy_name) {
+        const std::vector<std::unique_ptr<SimulatorDispatcher>> simulator_dispatchers =
+            get_combination_of_simulators(strategy_name);
+        std::vector<const SimulatorDispatcher *> batch_dispatchers;
+        for (size_t i = 0; i < simulator_dispatchers.size() && i < MaxBatchTradeSimulatorLanes; ++i)
+            batch_dispatchers.push_back(simulator_dispatchers[i].get());
+        for (const EvaluationPlan &evaluation_plan : _evaluation_plans) {
+            ASSERT_FALSE(evaluation_plan.periods.empty());
+            for (const EvaluationPeriod &evaluation_period : evaluation_plan.periods) {
+                AllocationCountingBatchSimulator batch_trade_simulator(
+                    batch_dispatchers.front()->new_batch_simulator(batch_dispatchers));
+                ASSERT_EQ(batch_trade_simulator.size(), batch_dispatchers.size());
+                const std::vector<SimulationResult> simulation_results =
+                    execute_batch_trade_simulation(_account_config, evaluation_period, nullptr, batch_trade_simulator);
+                ASSERT_TRUE(batch_trade_simulator.updated());
+                // Only the result vector, allocated before the first update, is returned
+                EXPECT_EQ(batch_trade_simulator.allocations_since_first_update(), 0u);
+                EXPECT_EQ(simulation_results.size(), batch_dispatchers.size());
+            }
+        }
+    }
+
+    OhlcHistory _ohlc_history;
+    OhlcHistoryView _ohlc_history_view;
+    OhlcColumns _ohlc_columns;
+    OhlcRangeIndex _ohlc_range_index;
+    AccountConfig _account_config;
+    std::vector<EvaluationPlan> _evaluation_plans;
+};
+
+TEST(AllocationCounterTest, CountsAllocations) {
+    ASSERT_TRUE(AllocationCountingEnabled) << "tests have to be built with COUNT_ALLOCATIONS";
+    const size_t allocation_count = thread_allocation_count();
+    const std::unique_ptr<int> allocated(new int(1));
+    EXPECT_EQ(thread_allocation_count(), allocation_count + 1);
+}
+
+TEST_F(SimulationAllocationTest, RebalancingSimulatorDoesNotAllocate) {
+    expect_no_allocation<RebalancingTradeSimulator>(std::vector<RebalancingTradeSimulatorConfig>{
+        {0.1f, 0.01f}, {0.5f, 0.05f}, {0.7f, 0.05f}, {0.9f, 0.2f}});
+}
+
+TEST_F(SimulationAllocationTest, StopSimulatorDoesNotAllocate) {
+    expect_no_allocation<StopTradeSimulator>(std::vector<StopTradeSimulatorConfig>{
+        {0.05f, 0.05f, 0.01f, 0.01f}, {0.1f, 0.1f, 0.01f, 0.1f}, {0.2f, 0.15f, 0.1f, 0.05f}});
+}
+
+TEST_F(SimulationAllocationTest, BatchRebalancingSimulatorDoesNotAllocate) {
+    expect_no_batch_allocation("rebalancing");
+}
+
+TEST_F(SimulationAllocationTest, BatchStopSimulatorDoesNotAllocate) { expect_no_batch_allocation("stop"); }
+} // namespace
+} // namespace back_trader
@@ -0,0 +1,160 @@
+/*
+ Benchmark of the simulation loop, the TradeSimulator interface (virtual update on every tick) against
+ execute_trade_simulation specialized for the strategy class (statically dispatched, inlined update) on the same
+ history. Usage: backtesting_benchmark [ohlc_history.mov], synthetic 1 minute history of a year without the file.
+*/
+#include "execution/simulation_executor.hpp"
+#include "simulators/strategy/rebalancing_trade_simulator.hpp"
+#include "simulators/strategy/stop_trade_simulator.hpp"
+#include "test_history.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace back_trader {
+namespace {
+constexpr int BenchmarkRepetitions = 5;
+
+/*
+ Simulator without event skipping executed through TradeSimulator interface, same as the loop before the simulation
+ was specialized for the strategy class (one virtual update per tick, every tick executed).
+*/
+template <typename Simulator>
+class NoSkipSimulator final : public TradeSimulator {
+  public:
+    template <typename Config>
+    explicit NoSkipSimulator(const Config &config) : _simulator(config) {}
+
+    void update(const OhlcTick &ohlc_tick, const std::vector<float> &fear_and_greed_input_signals, float base_balance,
+                float quote_balance, std::vector<Order> &orders) override {
+        _simulator.update(ohlc_tick, fear_and_greed_input_signals, base_balance, quote_balance, orders);
+    }
+    void write_internal_state(std::ostream &os) const override { _simulator.write_internal_state(os); }
+
+  private:
+    Simulator _simulator;
+};
+
+// Best time of BenchmarkRepetitions runs of simulation in nanoseconds per OHLC tick, result of the last run.
+double get_ns_per_tick(const EvaluationPeriod &evaluation_period, const std::function<SimulationResult()> &simulation,
+                       SimulationResult &simulation_result) {
+    double best_ns = std::numeric_limits<double>::max();
+    for (int i = 0; i < BenchmarkRepetitions; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        simulation_result = simulation();
+        const auto end = std::chrono::steady_clock::now();
+        best_ns = std::min(best_ns, std::chrono::duration<double, std::nano>(end - start).count());
+    }
+    return best_ns / evaluation_period.size();
+}
+
+// Prints ns per tick of every way to execute Simulator with config, returns false if their results differ.
+template <typename Simulator, typename Config>
+bool benchmark_simulator(const char *strategy_name, const Config &config, const AccountConfig &account_config,
+                         const EvaluationPeriod &evaluation_period, const EvaluationPeriod &indexed_evaluation_period) {
+    SimulationResult old_loop_result;
+    const double old_loop_ns = get_ns_per_tick(
+        evaluation_period,
+        [&]() {
+            NoSkipSimulator<Simulator> trade_simulator(config);
+            return execute_trade_simulation(account_config, evaluation_period, nullptr, true,
+                                            static_cast<TradeSimulator &>(trade_simulator), nullptr);
+        },
+        old_loop_result);
+
+    SimulationResult virtual_result;
+    const double virtual_ns = get_ns_per_tick(
+        evaluation_period,
+        [&]() {
+            Simulator trade_simulator(config);
+            return execute_trade_simulation(account_config, evaluation_period, nullptr, true,
+                                            static_cast<TradeSimulator &>(trade_simulator), nullptr);
+        },
+        virtual_result);
+
+    SimulationResult static_result;
+    const double static_ns = get_ns_per_tick(
+        evaluation_period,
+        [&]() {
+            Simulator trade_simulator(config);
+            NoSimulationLogger no_logger;
+            return execute_trade_simulation<Simulator, NoSimulationLogger>(account_config, evaluation_period, nullptr,
+                                                                          true, trade_simulator, no_logger);
+        },
+        static_result);
+
+    SimulationResult indexed_result;
+    const double indexed_ns = get_ns_per_tick(
+        indexed_evaluation_period,
+        [&]() {
+            Simulator trade_simulator(config);
+            NoSimulationLogger no_logger;
+            return execute_trade_simulation<Simulator, NoSimulationLogger>(
+                account_config, indexed_evaluation_period, nullptr, true, trade_simulator, no_logger);
+        },
+        indexed_result);
+
+    std::printf("%s\n", strategy_name);
+    std::printf("  virtual update, every tick           %8.2f ns/tick\n", old_loop_ns);
+    std::printf("  virtual update, skipping             %8.2f ns/tick  %5.2fx\n", virtual_ns, old_loop_ns / virtual_ns);
+    std::printf("  static update, skipping              %8.2f ns/tick  %5.2fx\n", static_ns, old_loop_ns / static_ns);
+    std::printf("  static update, skipping, range index %8.2f ns/tick  %5.2fx\n", indexed_ns,
+                old_loop_ns / indexed_ns);
+    // Every way has to give bit identical result
+    const bool same_results = std::memcmp(&old_loop_result, &virtual_result, sizeof(SimulationResult)) == 0 &&
+                              std::memcmp(&old_loop_result, &static_result, sizeof(SimulationResult)) == 0 &&
+                              std::memcmp(&old_loop_result, &indexed_result, sizeof(SimulationResult)) == 0;
+    if (!same_results)
+        std::printf("  results differ\n");
+    return same_results;
+}
+} // namespace
+} // namespace back_trader
+
+int main(int argc, char *argv[]) {
+    using namespace back_trader;
+    OhlcHistoryView ohlc_history_view;
+    OhlcHistory ohlc_history;
+    if (argc > 1) {
+        ohlc_history_view = read_history_view_from_binary_file<OhlcTick>(argv[1], 0,
+                                                                         std::numeric_limits<std::time_t>::max());
+    } else {
+        ohlc_history = get_random_walk_ohlc_history(365 * 24 * 60);
+        ohlc_history_view = OhlcHistoryView(ohlc_history);
+    }
+    if (ohlc_history_view.empty()) {
+        std::printf("No OHLC history\n");
+        return EXIT_FAILURE;
+    }
+    const OhlcColumns ohlc_columns(ohlc_history_view);
+    const OhlcRangeIndex ohlc_range_index(ohlc_history_view, ohlc_columns);
+    const SimEvaluationConfig sim_evaluation_config{ohlc_history_view.front().timestamp_sec,
+                                                    ohlc_history_view.back().timestamp_sec + 1,
+                                                    {0, EvaluationTimeSpan::Unit::DAY},
+                                                    {0, EvaluationTimeSpan::Unit::DAY},
+                                                    /*fast_execute=*/true};
+    const EvaluationPlan evaluation_plan = get_evaluation_plan(sim_evaluation_config, ohlc_history_view);
+    const EvaluationPlan indexed_evaluation_plan =
+        get_evaluation_plan(sim_evaluation_config, ohlc_history_view, &ohlc_range_index);
+    if (evaluation_plan.periods.size() != 1 || indexed_evaluation_plan.periods.size() != 1) {
+        std::printf("No evaluation period\n");
+        return EXIT_FAILURE;
+    }
+    const AccountConfig account_config = get_test_account_config();
+    std::printf("%zu OHLC ticks, best of %d runs\n", ohlc_history_view.size(), BenchmarkRepetitions);
+
+    bool same_results = benchmark_simulator<RebalancingTradeSimulator>(
+        "rebalancing [0.7|0.05]", RebalancingTradeSimulatorConfig{0.7f, 0.05f}, account_config,
+        evaluation_plan.periods.front(), indexed_evaluation_plan.periods.front());
+    same_results &= benchmark_simulator<StopTradeSimulator>(
+        "stop [0.1|0.1|0.01|0.1]", StopTradeSimulatorConfig{0.1f, 0.1f, 0.01f, 0.1f}, account_config,
+        evaluation_plan.periods.front(), indexed_evaluation_plan.periods.front());
+    return same_results ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,165 @@
+#include "execution/simulation_executor.hpp"
+#include "simulators/simulator_factory.hpp"
+#include "simulators/strategy/rebalancing_trade_simulator.hpp"
+#include "simulators/strategy/stop_trade_simulator.hpp"
+#include "test_history.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace back_trader {
+namespace {
+// Simulator forwarding only the updates to Simulator, every tick is updated (can_skip of TradeSimulator is false).
+template <typename Simulator>
+class NoSkipSimulator final : public TradeSimulator {
+  public:
+    template <typename Config>
+    explicit NoSkipSimulator(const Config &config) : _simulator(config) {}
+
+    void update(const OhlcTick &ohlc_tick, const std::vector<float> &fear_and_greed_input_signals, float base_balance,
+                float quote_balance, std::vector<Order> &orders) override {
+        _simulator.update(ohlc_tick, fear_and_greed_input_signals, base_balance, quote_balance, orders);
+    }
+    void write_internal_state(std::ostream &os) const override { _simulator.write_internal_state(os); }
+
+  private:
+    Simulator _simulator;
+};
+
+// Simulator forwarding to Simulator (skipping ticks as it does), counts the updates.
+template <typename Simulator>
+class UpdateCountingSimulator final : public TradeSimulator {
+  public:
+    template <typename Config>
+    explicit UpdateCountingSimulator(const Config &config) : _simulator(config) {}
+
+    void update(const OhlcTick &ohlc_tick, const std::vector<float> &fear_and_greed_input_signals, float base_balance,
+                float quote_balance, std::vector<Order> &orders) override {
+        ++_update_count;
+        _simulator.update(ohlc_tick, fear_and_greed_input_signals, base_balance, quote_balance, orders);
+    }
+    void write_internal_state(std::ostream &os) const override { _simulator.write_internal_state(os); }
+    bool can_skip(const OhlcRange &ohlc_range) const override { return _simulator.can_skip(ohlc_range); }
+    void skip(const OhlcTick &last_tick) override { _simulator.skip(last_tick); }
+
+    size_t update_count() const { return _update_count; }
+
+  private:
+    Simulator _simulator;
+    size_t _update_count = 0;
+};
+
+void expect_same_simulation_results(const SimulationResult &result, const SimulationResult &expected_result) {
+    EXPECT_EQ(result.start_base_balance, expected_result.start_base_balance);
+    EXPECT_EQ(result.start_quote_balance, expected_result.start_quote_balance);
+    EXPECT_EQ(result.end_base_balance, expected_result.end_base_balance);
+    EXPECT_EQ(result.end_quote_balance, expected_result.end_quote_balance);
+    EXPECT_EQ(result.start_price, expected_result.start_price);
+    EXPECT_EQ(result.end_price, expected_result.end_price);
+    EXPECT_EQ(result.start_value, expected_result.start_value);
+    EXPECT_EQ(result.end_value, expected_result.end_value);
+    EXPECT_EQ(result.total_order, expected_result.total_order);
+    EXPECT_EQ(result.total_fee, expected_result.total_fee);
+    EXPECT_EQ(result.base_volatility, expected_result.base_volatility);
+    EXPECT_EQ(result.simulator_volatility, expected_result.simulator_volatility);
+}
+
+// 4 weeks of 1 minute ticks evaluated in weekly windows, with and without range index.
+class SimulationEquivalenceTest : public ::testing::Test {
+  protected:
+    SimulationEquivalenceTest()
+        : _ohlc_history(get_random_walk_ohlc_history(28 * 24 * 60)), _ohlc_history_view(_ohlc_history),
+          _ohlc_columns(_ohlc_history_view), _ohlc_range_index(_ohlc_history_view, _ohlc_columns),
+          _account_config(get_test_account_config()) {
+        const SimEvaluationConfig sim_evaluation_config = get_test_evaluation_config(_ohlc_history_view, 7, 7);
+        _evaluation_plans.push_back(get_evaluation_plan(sim_evaluation_config, _ohlc_history_view));
+        _evaluation_plans.push_back(get_evaluation_plan(sim_evaluation_config, _ohlc_history_view, &_ohlc_range_index));
+    }
+
+    // Results of Simulator with config skipping ticks (static and virtual loop) are the ones of updating every tick.
+    template <typename Simulator, typename Config>
+    void expect_same_results_with_skipping(const Config &config) {
+        for (const EvaluationPlan &evaluation_plan : _evaluation_plans) {
+            ASSERT_FALSE(evaluation_plan.periods.empty());
+            int32_t total_order = 0;
+            for (const EvaluationPeriod &evaluation_period : evaluation_plan.periods) {
+                NoSkipSimulator<Simulator> no_skip_simulator(config);
+                const SimulationResult expected_result =
+                    execute_trade_simulation(_account_config, evaluation_period, nullptr, true,
+                                             static_cast<TradeSimulator &>(no_skip_simulator), nullptr);
+                total_order += expected_result.total_order;
+
+                Simulator static_simulator(config);
+                NoSimulationLogger no_logger;
+                const SimulationResult static_result = execute_trade_simulation<Simulator, NoSimulationLogger>(
+                    _account_config, evaluation_period, nullptr, true, static_simulator, no_logger);
+                expect_same_simulation_results(static_result, expected_result);
+
+                UpdateCountingSimulator<Simulator> virtual_simulator(config);
+                const SimulationResult virtual_result =
+                    execute_trade_simulation(_account_config, evaluation_period, nullptr, true,
+                                             static_cast<TradeSimulator &>(virtual_simulator), nullptr);
+                expect_same_simulation_results(virtual_result, expected_result);
+                // Ticks were skipped indeed
+                EXPECT_LT(virtual_simulator.update_count(), evaluation_period.size());
+            }
+            EXPECT_GT(total_order, 0);
+        }
+    }
+
+    // Result of every lane of batches of strategy_name combinations is the one of its simulator executed alone.
+    void expect_same_results_in_batch(const std::string &strategy_name) {
+        const std::vector<std::unique_ptr<SimulatorDispatcher>> simulator_dispatchers =
+            get_combination_of_simulators(strategy_name);
+        ASSERT_GT(simulator_dispatchers.size(), MaxBatchTradeSimulatorLanes);
+        for (const EvaluationPlan &evaluation_plan : _evaluation_plans) {
+            for (const EvaluationPeriod &evaluation_period : evaluation_plan.periods) {
+                // Full batches and the partial last one
+                for (size_t begin = 0; begin < simulator_dispatchers.size(); begin += MaxBatchTradeSimulatorLanes) {
+                    std::vector<const SimulatorDispatcher *> batch_dispatchers;
+                    for (size_t i = begin; i < simulator_dispatchers.size() && i < begin + MaxBatchTradeSimulatorLanes;
+                         ++i)
+                        batch_dispatchers.push_back(simulator_dispatchers[i].get());
+                    const std::unique_ptr<BatchTradeSimulator> batch_trade_simulator =
+                        batch_dispatchers.front()->new_batch_simulator(batch_dispatchers);
+                    const std::vector<SimulationResult> simulation_results = execute_batch_trade_simulation(
+                        _account_config, evaluation_period, nullptr, *batch_trade_simulator);
+                    ASSERT_EQ(simulation_results.size(), batch_dispatchers.size());
+                    for (size_t i = 0; i < batch_dispatchers.size(); ++i) {
+                        SCOPED_TRACE(batch_dispatchers[i]->get_names());
+                        expect_same_simulation_results(
+                            simulation_results[i],
+                            evaluate_period(_account_config, evaluation_period, *batch_dispatchers[i], nullptr).result);
+                    }
+                }
+            }
+        }
+    }
+
+    OhlcHistory _ohlc_history;
+    OhlcHistoryView _ohlc_history_view;
+    OhlcColumns _ohlc_columns;
+    OhlcRangeIndex _ohlc_range_index;
+    AccountConfig _account_config;
+    std::vector<EvaluationPlan> _evaluation_plans;
+};
+
+TEST_F(SimulationEquivalenceTest, RebalancingSimulatorSkippingTicksHasSameResult) {
+    expect_same_results_with_skipping<RebalancingTradeSimulator>(RebalancingTradeSimulatorConfig{0.7f, 0.05f});
+}
+
+TEST_F(SimulationEquivalenceTest, StopSimulatorSkippingTicksHasSameResult) {
+    expect_same_results_with_skipping<StopTradeSimulator>(StopTradeSimulatorConfig{0.1f, 0.1f, 0.01f, 0.1f});
+}
+
+TEST_F(SimulationEquivalenceTest, BatchRebalancingSimulatorHasSameResults) {
+    expect_same_results_in_batch("rebalancing");
+}
+
+TEST_F(SimulationEquivalenceTest, BatchStopSimulatorHasSameResults) { expect_same_results_in_batch("stop"); }
+} // namespace
+} // namespace back_trader
@@ -0,0 +1,61 @@
+#pragma once
+#include "execution/simulation_types.hpp"
+#include <base_header.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <random>
+
+namespace back_trader {
+// Start of the synthetic histories, 2021-01-01 00:00:00 UTC.
+constexpr std::time_t TestHistoryStartTimestampSec = 1609459200;
+
+/*
+ Synthetic 1 minute OHLC history of tick_count ticks, random walk of the price around 30000 with seed (same seed same
+ history). Every 50th tick has zero volume (missing price history).
+*/
+inline OhlcHistory get_random_walk_ohlc_history(size_t tick_count, uint32_t seed = 1) {
+    std::mt19937 random_generator(seed);
+    std::normal_distribution<float> return_distribution(0.0f, 0.002f);
+    std::uniform_real_distribution<float> wick_distribution(0.0f, 0.001f);
+    std::uniform_real_distribution<float> volume_distribution(1.0f, 100.0f);
+    OhlcHistory ohlc_history;
+    ohlc_history.reserve(tick_count);
+    float price = 30000.0f;
+    for (size_t i = 0; i < tick_count; ++i) {
+        const float open = price;
+        price *= std::exp(return_distribution(random_generator));
+        const float high = std::max(open, price) * (1 + wick_distribution(random_generator));
+        const float low = std::min(open, price) * (1 - wick_distribution(random_generator));
+        const float volume = i % 50 == 49 ? 0.0f : volume_distribution(random_generator);
+        ohlc_history.push_back({TestHistoryStartTimestampSec + int64_t(i) * 60, open, high, low, price, volume});
+    }
+    return ohlc_history;
+}
+
+// Account with both currencies, fees of every order type and limit orders capped by the tick volume.
+inline AccountConfig get_test_account_config() {
+    AccountConfig config;
+    config.start_base_balance = 1.0f;
+    config.start_quote_balance = 30000.0f;
+    config.base_unit = 0.00001f;
+    config.quote_unit = 0.01f;
+    config.market_order_fee_config = {0.005f, 0.0f, 0.0f};
+    config.limit_order_fee_config = {0.005f, 0.0f, 0.0f};
+    config.stop_order_fee_config = {0.005f, 0.0f, 0.0f};
+    config.market_liquidity = 0.5f;
+    config.max_volume_ratio = 0.5f;
+    return config;
+}
+
+// Windows of window_days days starting every step_days days over the whole ohlc_history.
+inline SimEvaluationConfig get_test_evaluation_config(const OhlcHistoryView &ohlc_history, int32_t window_days,
+                                                      int32_t step_days) {
+    return SimEvaluationConfig{ohlc_history.front().timestamp_sec,
+                               ohlc_history.back().timestamp_sec + 60,
+                               {window_days, EvaluationTimeSpan::Unit::DAY},
+                               {step_days, EvaluationTimeSpan::Unit::DAY},
+                               /*fast_execute=*/true};
+}
+} // namespace back_trader